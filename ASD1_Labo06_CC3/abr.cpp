@@ -13,16 +13,383 @@
 #include <cassert>
 #include <stdexcept>
 #include <stack>
+#include <algorithm>
+#include <vector>
+#include <memory>
+#include <utility>
+#include <type_traits>
+#include <iterator>
+#include <string_view>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#if __cplusplus > 201703L && __has_include(<compare>)
+#include <compare>
+#endif
+#include "taskpool.cpp"
+#include "reclaimer.cpp"
+#include "trace.cpp"
+#include "stats.cpp"
 
 using namespace std;
 
+//
+// Les opérations de l'arbre sont itératives: la pile d'appel reste bornée
+// même sur un arbre dégénéré. Compiler avec -DABR_RECURSIVE pour utiliser
+// les versions récursives, par exemple pour les comparer (voir bench.cpp).
+//
+
+//
+// @brief Allocateur par défaut des noeuds
+//
+// Chaque noeud est alloué par new et libéré par delete.
+//
+template < typename Node >
+struct NewDeleteAllocator {
+    // create et destroy peuvent etre appelés par plusieurs threads à la fois
+    static constexpr bool threadSafe = true;
+
+    template < typename... Args >
+    Node* create(Args&&... args) {
+        return new Node(std::forward<Args>(args)...);
+    }
+
+    void destroy(Node* n) noexcept {
+        delete n;
+    }
+
+    //
+    // @brief Libère en bloc tous les noeuds, sans les détruire
+    //
+    // @return faux: chaque noeud doit etre libéré par destroy
+    //
+    bool releaseAll() noexcept {
+        return false;
+    }
+
+    //
+    // Deux allocateurs égaux peuvent libérer les noeuds l'un de l'autre
+    //
+    bool operator == (const NewDeleteAllocator&) const noexcept {
+        return true;
+    }
+};
+
+//
+// @brief Allocateur de noeuds par blocs contigus
+//
+// Les noeuds sont distribués depuis des blocs de BlockSize emplacements.
+// Les noeuds libérés sont recyclés par une liste chainée (free list)
+// construite dans les emplacements eux-mêmes.
+//
+// Les copies d'un PoolAllocator partagent la meme réserve, ce qui permet
+// à des arbres issus de split de s'échanger leurs noeuds. Une réserve ne
+// doit pas etre utilisée par plusieurs threads à la fois.
+//
+template < typename Node, size_t BlockSize = 1024 >
+class PoolAllocator {
+    union Slot {
+        Slot* next;
+        alignas(Node) unsigned char storage[sizeof(Node)];
+    };
+
+    struct Arena {
+        vector<unique_ptr<Slot[]>> blocks; // blocs alloués
+        Slot* freeList = nullptr;          // emplacements libérés
+        size_t used = BlockSize;           // emplacements utilisés du dernier bloc
+    };
+
+    shared_ptr<Arena> arena; // créée à la première allocation
+
+public:
+    static constexpr bool threadSafe = false;
+
+    template < typename... Args >
+    Node* create(Args&&... args) {
+        if(arena == nullptr)
+            arena = make_shared<Arena>();
+        Slot* s = acquire();
+        try {
+            return new (s->storage) Node(std::forward<Args>(args)...);
+        } catch(...) {
+            s->next = arena->freeList;
+            arena->freeList = s;
+            throw;
+        }
+    }
+
+    void destroy(Node* n) noexcept {
+        n->~Node();
+        Slot* s = reinterpret_cast<Slot*>(n);
+        s->next = arena->freeList;
+        arena->freeList = s;
+    }
+
+    //
+    // @brief Rend tous les blocs si la réserve n'est pas partagée. Les
+    //        noeuds ne sont pas détruits.
+    //
+    // @return vrai si les blocs ont été rendus
+    //
+    //  Complexité: O(#blocs)
+    //
+    bool releaseAll() noexcept {
+        if(arena != nullptr && arena.use_count() > 1)
+            return false;
+        arena.reset();
+        return true;
+    }
+
+    bool operator == (const PoolAllocator& other) const noexcept {
+        return arena == other.arena;
+    }
+
+private:
+    Slot* acquire() {
+        if(arena->freeList != nullptr) {
+            Slot* s = arena->freeList;
+            arena->freeList = s->next;
+            return s;
+        }
+        if(arena->used == BlockSize) {
+            unique_ptr<Slot[]> block(new Slot[BlockSize]);
+            arena->blocks.push_back(std::move(block));
+            arena->used = 0;
+        }
+        return &arena->blocks.back()[arena->used++];
+    }
+};
+
+//
+// @brief Politique par défaut: aucun rééquilibrage pendant les mises à jour
+//
+// L'arbre n'est équilibré que par un appel explicite à balance().
+//
+struct NoBalancing {
+    struct NodeData {};
+};
+
+//
+// @brief Politique AVL
+//
+// insert, deleteElement et deleteMin effectuent des rotations en remontant
+// le chemin de recherche. La hauteur reste en O(log(n)).
+//
+struct AVLBalancing {
+    struct NodeData {
+        int height = 1; // hauteur du sous arbre dont ce noeud est la racine
+    };
+};
+
+//
+// @brief Politique bouc émissaire (scapegoat) pondérée par nbElements
+//
+// En remontant d'une insertion ou d'une suppression, tout sous arbre dont
+// un enfant contient plus de Num/Den de ses noeuds est reconstruit par
+// linearize / arborize. Seul ce sous arbre est reconstruit. Complexité
+// amortie O(log(n)) par mise à jour.
+//
+template < size_t Num = 2, size_t Den = 3 >
+struct ScapegoatBalancing {
+    static_assert(2 * Num > Den && Num < Den, "Num/Den doit etre dans ]1/2, 1[");
+
+    struct NodeData {};
+
+    static bool tooHeavy(size_t child, size_t n) noexcept {
+        return child * Den > Num * n;
+    }
+};
+
+template < typename B >
+struct isWeightBalanced : false_type {};
+
+template < size_t Num, size_t Den >
+struct isWeightBalanced<ScapegoatBalancing<Num, Den>> : true_type {};
+
+//
+// @brief Politique de rééquilibrage automatique selon la hauteur
+//
+// Après chaque insertion, la profondeur du nouveau noeud est comparée à
+// maxHeight(n) = factor (log2(n) + 1), où log2(n) + 1 est la hauteur d'un
+// arbre de n noeuds parfaitement équilibré. Si elle la dépasse, un
+// ancetre du nouveau noeud est reconstruit (bouc émissaire), trouvé en
+// remontant par les parents: le premier dont le sous arbre est lui-meme
+// trop haut selon le meme critère et dont la reconstruction ramène le
+// nouveau noeud sous la limite. Si wholeTree est vrai, tout l'arbre est
+// équilibré par balance(). Les suppressions n'augmentent pas la hauteur
+// et ne déclenchent rien.
+//
+// Les seuils se règlent à l'exécution. onRebalance, s'il est défini, est
+// appelé après chaque rééquilibrage avec sa durée. Seuils et hook sont
+// partagés par tous les arbres qui utilisent la meme politique. Tag
+// permet d'en obtenir des indépendants.
+//
+// Rien n'est maintenu dans les noeuds: les mises à jour restent
+// itératives. Complexité amortie O(log(n)) par insertion si factor > 1.
+//
+template < typename Tag = void >
+class AutoBalancing {
+public:
+    struct NodeData {};
+
+    struct Thresholds {
+        double factor = 2.0;    // hauteur tolérée, en multiple de log2(n) + 1. >= 1
+        size_t minSize = 64;    // en dessous, l'arbre n'est pas rééquilibré
+        bool wholeTree = false; // balance() plutot que le sous arbre fautif
+    };
+
+    struct Event {
+        size_t depth;   // profondeur de l'insertion qui a déclenché
+        size_t size;    // taille de l'arbre
+        size_t rebuilt; // taille du sous arbre reconstruit
+        size_t ns;      // durée de la reconstruction
+    };
+
+    using Hook = void (*)(const Event&);
+    using Clock = chrono::steady_clock;
+
+    static void set_thresholds(const Thresholds& t) noexcept {
+        assert(t.factor >= 1);
+        factor.store(t.factor, memory_order_relaxed);
+        minSize.store(t.minSize, memory_order_relaxed);
+        wholeTree.store(t.wholeTree, memory_order_relaxed);
+    }
+
+    static Thresholds thresholds() noexcept {
+        return { factor.load(memory_order_relaxed), minSize.load(memory_order_relaxed),
+                 wholeTree.load(memory_order_relaxed) };
+    }
+
+    // nullptr pour ne plus etre appelé
+    static void set_on_rebalance(Hook h) noexcept {
+        hook.store(h, memory_order_release);
+    }
+
+    // nombre de rééquilibrages depuis le début
+    static size_t rebalance_count() noexcept {
+        return rebalances.load(memory_order_relaxed);
+    }
+
+    // hauteur tolérée pour un sous arbre de n noeuds
+    static double maxHeight(size_t n) noexcept {
+        return factor.load(memory_order_relaxed) * (std::log2(double(n)) + 1);
+    }
+
+    // vrai si une insertion à la profondeur depth dans un arbre de n
+    // noeuds doit déclencher un rééquilibrage
+    static bool triggers(size_t depth, size_t n) noexcept {
+        return n >= minSize.load(memory_order_relaxed) && double(depth) > maxHeight(n);
+    }
+
+    static bool rebuildsWholeTree() noexcept {
+        return wholeTree.load(memory_order_relaxed);
+    }
+
+    static void rebalanced(size_t depth, size_t n, size_t rebuilt, Clock::time_point start) noexcept {
+        rebalances.fetch_add(1, memory_order_relaxed);
+        if(Hook h = hook.load(memory_order_acquire)) {
+            size_t ns = size_t(chrono::duration_cast<chrono::nanoseconds>(Clock::now() - start).count());
+            h({ depth, n, rebuilt, ns });
+        }
+    }
+
+private:
+    inline static atomic<double> factor{ 2.0 };
+    inline static atomic<size_t> minSize{ 64 };
+    inline static atomic<bool> wholeTree{ false };
+    inline static atomic<Hook> hook{ nullptr };
+    inline static atomic<size_t> rebalances{ 0 };
+};
+
+template < typename B >
+struct isAutoBalanced : false_type {};
+
+template < typename Tag >
+struct isAutoBalanced<AutoBalancing<Tag>> : true_type {};
+
+//
+// @brief Vrai si le comparateur C accepte des clés d'autres types que
+//        celui de l'arbre, comme std::less<>
+//
+template < typename C, typename = void >
+struct isTransparent : false_type {};
+
+template < typename C >
+struct isTransparent<C, void_t<typename C::is_transparent>> : true_type {};
+
+//
+// @brief Vrai si le comparateur C fournit une comparaison à trois issues
+//        c.compare(a, b), négative, nulle ou positive
+//
+template < typename C, typename A, typename B, typename = void >
+struct hasThreeWayCompare : false_type {};
+
+template < typename C, typename A, typename B >
+struct hasThreeWayCompare<C, A, B, void_t<decltype(int(declval<const C&>().compare(declval<const A&>(), declval<const B&>())))>>
+        : true_type {};
+
 template < typename T >
+struct isStringKey : false_type {};
+
+template < typename Char, typename Traits, typename Alloc >
+struct isStringKey<basic_string<Char, Traits, Alloc>> : true_type {};
+
+template < typename Char, typename Traits >
+struct isStringKey<basic_string_view<Char, Traits>> : true_type {};
+
+//
+// @brief Vrai si a est une chaine comparable à b par a.compare(b)
+//
+template < typename A, typename B, typename = void >
+struct hasStringCompare : false_type {};
+
+template < typename A, typename B >
+struct hasStringCompare<A, B, enable_if_t<isStringKey<A>::value,
+                                          void_t<decltype(int(declval<const A&>().compare(declval<const B&>())))>>>
+        : true_type {};
+
+template < typename T, typename Compare, template < typename > class Allocator,
+           typename Balancing, typename Trace, typename Stats >
+class BinarySearchTree;
+
+//
+// @brief Arbre qui affiche ses créations et destructions de noeuds sur
+//        cout, pour les tests du laboratoire
+//
+template < typename T,
+           typename Compare = std::less<T>,
+           template < typename > class Allocator = NewDeleteAllocator,
+           typename Balancing = NoBalancing >
+using TracedBinarySearchTree = BinarySearchTree<T, Compare, Allocator, Balancing, CoutTrace, NoStats>;
+
+//
+// Les clés sont ordonnées par Compare, qui ne doit pas lever d'exception.
+// Si Compare est transparent, contains, rank, deleteElement et les
+// recherches de bornes acceptent aussi des clés d'un autre type, sans
+// construire de T.
+//
+// Trace est informée de chaque création et destruction de noeud (voir
+// trace.cpp). Par défaut, NoTrace ne coute rien.
+//
+// Stats compte les opérations insert, contains, deleteElement, rank,
+// nth_element, split et join, les noeuds qu'elles visitent, les
+// allocations et le temps passé dans balance() (voir stats.cpp). Par
+// défaut, NoStats ne coute rien.
+//
+template < typename T,
+           typename Compare = std::less<T>,
+           template < typename > class Allocator = NewDeleteAllocator,
+           typename Balancing = NoBalancing,
+           typename Trace = NoTrace,
+           typename Stats = NoStats >
 class BinarySearchTree {
 public:
 
     using value_type = T;
     using reference = T&;
     using const_reference = const T&;
+    using key_compare = Compare;
+    using stats_type = Stats;
 
 private:
     /**
@@ -30,27 +397,57 @@ private:
      *
      * contient une cle et les liens vers les sous-arbres droit et gauche.
      */
-    struct Node {
+    struct Node : Balancing::NodeData {
         const value_type key; // clé non modifiable
         Node* right;          // sous arbre avec des cles plus grandes
         Node* left;           // sous arbre avec des cles plus petites
+        Node* parent;         // noeud parent, nullptr pour la racine
         size_t nbElements;    // nombre de noeuds dans le sous arbre dont
         // ce noeud est la racine
 
-        Node(const_reference key)  // seul constructeur disponible. key est obligatoire
-                : key(key), right(nullptr), left(nullptr), nbElements(1)
+        Node(const_reference key)  // key est obligatoire
+                : key(key), right(nullptr), left(nullptr), parent(nullptr), nbElements(1)
         {
-            cout << "(C" << key << ") ";
         }
-        ~Node()               // destructeur
+        Node(value_type&& key)     // clé déplacée dans le noeud
+                : key(std::move(key)), right(nullptr), left(nullptr), parent(nullptr), nbElements(1)
+        {
+        }
+        template < typename... Args >
+        explicit Node(in_place_t, Args&&... args) // clé construite sur place
+                : key(std::forward<Args>(args)...), right(nullptr), left(nullptr), parent(nullptr), nbElements(1)
         {
-            cout << "(D" << key << ") ";
         }
         Node() = delete;             // pas de construction par défaut
         Node(const Node&) = delete;  // pas de construction par copie
         Node(Node&&) = delete;       // pas de construction par déplacement
     };
 
+#ifdef ABR_RECURSIVE
+    static constexpr bool iterative = false;
+#else
+    static constexpr bool iterative = true;
+#endif
+    // insert, deleteElement et deleteMin ne sont itératives que sans
+    // politique d'équilibrage ou avec AutoBalancing. Sinon elles
+    // rééquilibrent en remontant un chemin de longueur O(log(n)).
+    static constexpr bool iterativeUpdates = iterative && (is_same<Balancing, NoBalancing>::value
+                                                           || isAutoBalanced<Balancing>::value);
+
+    // noeuds visités par une opération, pour Stats. Vide avec NoStats.
+    using Path = typename Stats::Path;
+
+    // profondeur à partir de laquelle un arbre déséquilibré n'est plus
+    // découpé en taches parallèles
+    static constexpr size_t parallelMaxDepth = 48;
+
+    // taille minimale d'un sous arbre copié ou détruit par une tache séparée
+    static constexpr size_t copyGrain = size_t(1) << 16;
+
+public:
+    using allocator_type = Allocator<Node>;
+
+private:
     /**
      *  @brief Copie le noeud
      *
@@ -58,14 +455,19 @@ private:
      *
      *  Complexité: O(n)
      */    
-    static Node* copyNode(Node* r){
+    Node* copyNode(Node* r){
         Node *node = nullptr;
         try {
             if (r != nullptr) {
-                node = new Node(r->key);
+                node = createNode(r->key);
                 node->nbElements = r->nbElements;
+                static_cast<typename Balancing::NodeData&>(*node) = *r;
                 node->left = copyNode(r->left);
+                if(node->left != nullptr)
+                    node->left->parent = node;
                 node->right = copyNode(r->right);
+                if(node->right != nullptr)
+                    node->right->parent = node;
                 return node;
             }
             return r;
@@ -77,11 +479,339 @@ private:
         }
     }
 
+    static size_t sizeOf(Node* r) noexcept {
+        return r ? r->nbElements : 0;
+    }
+
+    // hauteur du sous arbre de n noeuds construit par arborize
+    static size_t balancedHeight(size_t n) noexcept {
+        size_t h = 0;
+        for(; n != 0; n >>= 1)
+            ++h;
+        return h;
+    }
+
+    static int heightOf(Node* r) noexcept {
+        return r ? r->height : 0;
+    }
+
+    /**
+     *  @brief Recalcule les informations du noeud à partir de ses enfants
+     *         et rattache ces derniers à r
+     *
+     *  @param r le noeud à mettre à jour. ne peut pas etre nullptr
+     *
+     *  Complexité: O(1)
+     */
+    static void update(Node* r) noexcept {
+        if(r->left != nullptr)
+            r->left->parent = r;
+        if(r->right != nullptr)
+            r->right->parent = r;
+        r->nbElements = 1 + sizeOf(r->left) + sizeOf(r->right);
+        if constexpr (is_same<Balancing, AVLBalancing>::value)
+            r->height = 1 + std::max(heightOf(r->left), heightOf(r->right));
+    }
+
+    /**
+     *  @brief Rotations simples. nbElements est maintenu.
+     *
+     *  @param r reference a la racine du sous arbre a tourner
+     *
+     *  Complexité: O(1)
+     */
+    static void rotateRight(Node*& r) noexcept {
+        Node* l = r->left;
+        r->left = l->right;
+        l->right = r;
+        l->parent = r->parent;
+        update(r);
+        update(l);
+        r = l;
+    }
+
+    static void rotateLeft(Node*& r) noexcept {
+        Node* l = r->right;
+        r->right = l->left;
+        l->left = r;
+        l->parent = r->parent;
+        update(r);
+        update(l);
+        r = l;
+    }
+
+    /**
+     *  @brief Met a jour le noeud apres la modification d'un de ses
+     *         sous arbres et le rééquilibre selon la politique choisie
+     *
+     *  @param r reference a la racine du sous arbre. ne peut pas etre nullptr
+     *
+     *  Complexité: O(1)
+     */
+    static void rebalance(Node*& r) noexcept {
+        update(r);
+        if constexpr (is_same<Balancing, AVLBalancing>::value) {
+            int b = heightOf(r->left) - heightOf(r->right);
+            if(b > 1) {
+                if(heightOf(r->left->left) < heightOf(r->left->right))
+                    rotateLeft(r->left);
+                rotateRight(r);
+            } else if(b < -1) {
+                if(heightOf(r->right->right) < heightOf(r->right->left))
+                    rotateRight(r->right);
+                rotateLeft(r);
+            }
+        } else if constexpr (isWeightBalanced<Balancing>::value) {
+            if(Balancing::tooHeavy(std::max(sizeOf(r->left), sizeOf(r->right)), r->nbElements))
+                rebuild(r);
+        }
+    }
+
+    /**
+     *  @brief Reconstruit un sous arbre parfaitement équilibré
+     *
+     *  @param r reference a la racine du sous arbre
+     *
+     *  Complexité: O(n) où n est la taille du sous arbre
+     */
+    static void rebuild(Node*& r) noexcept {
+        Node* parent = r->parent;
+        size_t cnt = 0;
+        Node* list = nullptr;
+        if constexpr (iterative) {
+            linearizeIterative(r, list, cnt);
+            arborizeIterative(r, list, cnt);
+        } else {
+            linearize(r, list, cnt);
+            arborize(r, list, cnt);
+        }
+        r->parent = parent;
+    }
+
+    /**
+     *  @brief Copie un sous arbre sans récursion
+     *
+     *  @param r la racine du sous arbre à copier
+     *
+     *  Les noeuds sont créés dans le même ordre (préfixe) que copyNode.
+     *  En cas d'exception, la copie partielle est détruite dans le même
+     *  ordre que par copyNode: en remontant depuis la copie qui a échoué,
+     *  le sous arbre gauche complet de chaque ancetre puis l'ancetre.
+     *
+     *  Complexité: O(n)
+     */
+    Node* copyNodeIterative(Node* r) {
+        Node* copy = nullptr;
+        struct Todo {
+            Node* src;    // noeud à copier
+            Node** dst;   // emplacement de la copie
+            Node* parent; // parent de la copie
+        };
+        vector<Todo> todo;
+        Todo t{ r, &copy, nullptr };
+        try {
+            if(r != nullptr)
+                todo.push_back(t);
+            while(!todo.empty()) {
+                t = todo.back();
+                todo.pop_back();
+
+                Node* node = createNode(t.src->key);
+                node->nbElements = t.src->nbElements;
+                static_cast<typename Balancing::NodeData&>(*node) = *t.src;
+                node->parent = t.parent;
+                *t.dst = node;
+
+                if(t.src->right != nullptr)
+                    todo.push_back({ t.src->right, &node->right, node });
+                if(t.src->left != nullptr)
+                    todo.push_back({ t.src->left, &node->left, node });
+            }
+            return copy;
+        } catch(...) {
+            // le sous arbre droit d'un ancetre n'est commencé qu'une fois
+            // le gauche complet
+            Node* a = *t.dst != nullptr ? *t.dst : t.parent;
+            Node** from = *t.dst != nullptr ? nullptr : t.dst;
+            while(a != nullptr) {
+                if(from == &a->right)
+                    deleteSubTreeIterative(a->left);
+                Node* up = a->parent;
+                from = up == nullptr ? nullptr : up->left == a ? &up->left : &up->right;
+                destroyNode(a);
+                a = up;
+            }
+            throw;
+        }
+    }
+
+    /**
+     *  @brief Copie un sous arbre, les grands sous arbres par des taches
+     *         séparées
+     *
+     *  @param r la racine du sous arbre à copier
+     *  @param pool les threads effectuant la copie
+     *  @param depth la profondeur de r
+     *
+     *  En cas d'exception, les deux taches sont terminées puis la copie
+     *  partielle est détruite. Le parallélisme n'est utilisé que si
+     *  l'allocateur est threadSafe.
+     *
+     *  Complexité: O(n)
+     */
+    Node* copyNodeParallel(Node* r, TaskPool& pool, size_t depth) {
+        if(!allocator_type::threadSafe || sizeOf(r) < copyGrain || depth == parallelMaxDepth)
+            return iterative ? copyNodeIterative(r) : copyNode(r);
+
+        Node* node = createNode(r->key);
+        node->nbElements = r->nbElements;
+        static_cast<typename Balancing::NodeData&>(*node) = *r;
+        Node* left = nullptr;
+        Node* right = nullptr;
+        try {
+            pool.invoke([&] { left = copyNodeParallel(r->left, pool, depth + 1); },
+                        [&] { right = copyNodeParallel(r->right, pool, depth + 1); });
+        } catch(...) {
+            deleteSubTreeIterative(left);
+            deleteSubTreeIterative(right);
+            destroyNode(node);
+            throw;
+        }
+        node->left = left;
+        node->right = right;
+        update(node);
+        return node;
+    }
+
+    //
+    // Seuls les grands arbres utilisent TaskPool::global(), pour ne pas
+    // créer ses threads inutilement.
+    //
+    static bool copiesInParallel(Node* r) noexcept {
+        return allocator_type::threadSafe && sizeOf(r) >= copyGrain;
+    }
+
+    /**
+     *  @brief Construit un sous arbre équilibré de cnt clés lues dans first
+     *
+     *  @param cnt le nombre de clés à consommer
+     *  @param first IN - prochaine clé, OUT - clé suivant les cnt consommées
+     *  @param previous dernier noeud créé, pour vérifier l'ordre des clés
+     *
+     *  Meme forme qu'arborize. La profondeur de récursion est log2(cnt).
+     *
+     *  Complexité: O(cnt)
+     */
+    template < typename InputIt >
+    Node* buildSorted(size_t cnt, InputIt& first, Node*& previous) {
+        if(cnt == 0)
+            return nullptr;
+
+        Node* left = buildSorted((cnt - 1) / 2, first, previous);
+        Node* root;
+        try {
+            root = createNode(*first);
+            ++first;
+        } catch(...) {
+            deleteSubTreeIterative(left);
+            throw;
+        }
+        assert(previous == nullptr || _comp(previous->key, root->key));
+        previous = root;
+        root->left = left;
+
+        try {
+            root->right = buildSorted(cnt / 2, first, previous);
+        } catch(...) {
+            deleteSubTreeIterative(root);
+            throw;
+        }
+        update(root);
+        return root;
+    }
+
     /**
      *  @brief  Racine de l'arbre. nullptr si l'arbre est vide
      */
     Node* _root;
 
+    /**
+     *  @brief  Allocateur des noeuds de l'arbre
+     */
+    Allocator<Node> _alloc;
+
+    /**
+     *  @brief  Ordre des clés
+     */
+    Compare _comp;
+
+    //
+    // @brief Alloue et construit un noeud, puis le signale à Trace et Stats
+    //
+    template < typename... Args >
+    Node* createNode(Args&&... args) {
+        Node* n = _alloc.create(std::forward<Args>(args)...);
+        Trace::onCreate(*n);
+        Stats::allocated();
+        return n;
+    }
+
+    //
+    // @brief Signale la destruction du noeud à Trace et Stats, puis le
+    //        détruit
+    //
+    void destroyNode(Node* n) noexcept {
+        Trace::onDestroy(*n);
+        Stats::freed();
+        _alloc.destroy(n);
+    }
+
+    // restreint une surcharge aux comparateurs transparents
+    template < typename K >
+    using ifTransparent = enable_if_t<isTransparent<Compare>::value && !is_same<K, T>::value, int>;
+
+    //
+    // @brief Compare a et b en un seul appel si possible
+    //
+    // @return une valeur négative si a précède b, positive si b précède a,
+    //         nulle si elles sont équivalentes
+    //
+    // Utilise dans l'ordre: Compare::compare(a, b), puis pour std::less
+    // l'opérateur <=> (C++20) ou la méthode compare des chaines, sinon deux
+    // appels à Compare. Les descentes de contains, insert, rank et
+    // deleteElement ne comparent ainsi la clé qu'une fois par noeud.
+    //
+    template < typename A, typename B >
+    int compareKeys(const A& a, const B& b) const noexcept {
+        constexpr bool stdLess = is_same<Compare, less<T>>::value || is_same<Compare, less<>>::value;
+        if constexpr (hasThreeWayCompare<Compare, A, B>::value) {
+            int c = int(_comp.compare(a, b));
+            return c < 0 ? -1 : c > 0 ? 1 : 0;
+#if defined(__cpp_lib_three_way_comparison)
+        } else if constexpr (stdLess && three_way_comparable_with<A, B>) {
+            auto c = a <=> b;
+            return c < 0 ? -1 : c > 0 ? 1 : 0;
+#endif
+        } else if constexpr (stdLess && hasStringCompare<A, B>::value) {
+            int c = a.compare(b);
+            return c < 0 ? -1 : c > 0 ? 1 : 0;
+        } else if constexpr (stdLess && hasStringCompare<B, A>::value) {
+            int c = b.compare(a);
+            return c < 0 ? 1 : c > 0 ? -1 : 0;
+        } else
+            return _comp(a, b) ? -1 : _comp(b, a) ? 1 : 0;
+    }
+
+    /**
+     *  @brief  Thread de destruction différée. nullptr pour détruire
+     *          immédiatement. Propre à l'objet: n'est ni copié, ni
+     *          déplacé, ni échangé avec le contenu.
+     */
+    Reclaimer* _reclaimer = nullptr;
+
+    // taille minimale d'un arbre dont la destruction est différée
+    static constexpr size_t deferredGrain = size_t(1) << 10;
+
 public:
     /**
      *  @brief Constructeur par défaut. Construit un arbre vide
@@ -91,6 +821,47 @@ public:
     BinarySearchTree() : _root(nullptr) {
     }
 
+    /**
+     *  @brief Construit un arbre vide utilisant l'allocateur alloc
+     *
+     *  Avec PoolAllocator, les arbres construits à partir du meme
+     *  allocateur partagent sa réserve et peuvent etre joints.
+     *
+     *  Complexité: O(1)
+     */
+    explicit BinarySearchTree(const allocator_type& alloc) : _root(nullptr), _alloc(alloc) {
+    }
+
+    /**
+     *  @brief Construit un arbre vide ordonné par comp
+     *
+     *  Complexité: O(1)
+     */
+    explicit BinarySearchTree(const Compare& comp, const allocator_type& alloc = allocator_type())
+            : _root(nullptr), _alloc(alloc), _comp(comp) {
+    }
+
+    allocator_type get_allocator() const {
+        return _alloc;
+    }
+
+    key_compare key_comp() const {
+        return _comp;
+    }
+
+    /**
+     *  @brief Construit un arbre équilibré à partir de clés triées
+     *
+     *  @param first, last les clés, strictement croissantes selon comp
+     *
+     *  Complexité: O(n)
+     */
+    template < typename ForwardIt >
+    BinarySearchTree(ForwardIt first, ForwardIt last, const Compare& comp = Compare())
+            : _root(nullptr), _comp(comp) {
+        assign(first, last);
+    }
+
     /**
      *  @brief Constucteur de copie.
      *
@@ -98,8 +869,23 @@ public:
      *
      *  Complexité: O(n)
      */
-    BinarySearchTree(const BinarySearchTree& other ) {
-        _root = copyNode(other._root);
+    BinarySearchTree(const BinarySearchTree& other ) : _root(nullptr), _comp(other._comp) {
+        if(copiesInParallel(other._root))
+            _root = copyNodeParallel(other._root, TaskPool::global(), 0);
+        else
+            _root = iterative ? copyNodeIterative(other._root) : copyNode(other._root);
+    }
+
+    /**
+     *  @brief Constucteur de copie utilisant les threads de pool
+     *
+     *  Les grands sous arbres sont copiés par des taches séparées si
+     *  l'allocateur est threadSafe. Garantie forte en cas d'exception.
+     *
+     *  Complexité: O(n)
+     */
+    BinarySearchTree(const BinarySearchTree& other, TaskPool& pool) : _root(nullptr), _comp(other._comp) {
+        _root = copyNodeParallel(other._root, pool, 0);
     }
 
     /**
@@ -112,6 +898,7 @@ public:
     BinarySearchTree& operator = (const BinarySearchTree& other ) {
         BinarySearchTree tmp = other;
         swap(tmp);
+        tmp._reclaimer = _reclaimer;
         return *this;
     }
 
@@ -124,6 +911,8 @@ public:
      */
     void swap(BinarySearchTree& other ) noexcept {
         std::swap(_root, other._root);
+        std::swap(_alloc, other._alloc);
+        std::swap(_comp, other._comp);
     }
 
     /**
@@ -143,14 +932,69 @@ public:
      *
      *  @param other le BST dont on vole le contenu
      *
-     *  Complexité: O(1)
+     *  L'ancien contenu est détruit, en arrière plan si un Reclaimer est
+     *  associé à l'arbre.
+     *
+     *  Complexité: O(1) si la destruction est différée, O(n) sinon
      */
     BinarySearchTree& operator = ( BinarySearchTree&& other ) noexcept {
-        _root = nullptr;
-        swap(other);
+        BinarySearchTree old(std::move(other));
+        swap(old);
+        old._reclaimer = _reclaimer;
         return *this;
     }
 
+    /**
+     *  @brief Associe un thread de destruction différée à l'arbre
+     *
+     *  @param reclaimer le Reclaimer, qui doit survivre à l'arbre. nullptr
+     *                   pour revenir à la destruction immédiate.
+     *
+     *  Le destructeur, clear et les affectations confient alors au
+     *  Reclaimer les arbres d'au moins deferredGrain noeuds, si
+     *  l'allocateur est threadSafe.
+     */
+    void set_reclaimer(Reclaimer* reclaimer) noexcept {
+        _reclaimer = reclaimer;
+    }
+
+    Reclaimer* get_reclaimer() const noexcept {
+        return _reclaimer;
+    }
+
+    /**
+     *  @brief Remplace le contenu par un arbre équilibré construit à partir
+     *         de clés triées
+     *
+     *  @param first, last les clés, strictement croissantes
+     *
+     *  Les noeuds sont créés dans l'ordre des clés et placés directement à
+     *  la position qu'arborize leur donnerait, sans liste intermédiaire ni
+     *  recherche. Garantie forte en cas d'exception.
+     *
+     *  Complexité: O(n)
+     */
+    template < typename ForwardIt >
+    void assign(ForwardIt first, ForwardIt last) {
+        assign(size_t(std::distance(first, last)), first);
+    }
+
+    /**
+     *  @brief Idem à partir des n premières clés de first
+     *
+     *  @param n le nombre de clés
+     *  @param first début des clés, strictement croissantes
+     *
+     *  Complexité: O(n)
+     */
+    template < typename InputIt >
+    void assign(size_t n, InputIt first) {
+        BinarySearchTree tmp(_comp, _alloc);
+        Node* previous = nullptr;
+        tmp._root = tmp.buildSorted(n, first, previous);
+        swap(tmp);
+    }
+
     //
     // @brief Destructeur
     //
@@ -159,11 +1003,60 @@ public:
     //
     //  Complexité O(n)
     //
+    // Si l'allocateur peut tout rendre d'un coup, que les noeuds n'ont
+    // rien à détruire et que Trace ne suit pas les destructions, les blocs
+    // sont rendus sans parcourir l'arbre. Stats les compte alors en une
+    // fois.
+    //
+    // Un grand arbre est détruit en parallèle par TaskPool::global() si
+    // l'allocateur est threadSafe.
+    //
+    // Avec un Reclaimer, les noeuds d'un grand arbre sont confiés à son
+    // thread.
+    //
     ~BinarySearchTree() {
-        if(_root != nullptr)
+        size_t n = sizeOf(_root);
+        if(is_trivially_destructible<Node>::value && !Trace::tracesDestruction && _alloc.releaseAll()) {
+            Stats::freed(n);
+            return;
+        }
+        if(_reclaimer != nullptr && allocator_type::threadSafe && sizeOf(_root) >= deferredGrain) {
+            size_t bytes = _root->nbElements * sizeof(Node);
+            BinarySearchTree detached(_alloc);
+            std::swap(_root, detached._root);
+            _reclaimer->dispose(std::move(detached), bytes);
+            // detached est encore plein si le Reclaimer n'a pas pu le prendre
+            return;
+        }
+        if(copiesInParallel(_root))
+            deleteSubTreeParallel( _root, TaskPool::global(), 0 );
+        else if(iterative)
+            deleteSubTreeIterative( _root );
+        else if(_root != nullptr)
             deleteSubTree( _root );
     }
 
+    //
+    // @brief Vide l'arbre, en arrière plan si un Reclaimer lui est associé
+    //
+    //  Complexité O(1) si la destruction est différée, O(n) sinon
+    //
+    void clear() noexcept {
+        BinarySearchTree old(_alloc);
+        std::swap(_root, old._root);
+        old._reclaimer = _reclaimer;
+    }
+
+    //
+    // @brief Vide l'arbre en détruisant ses noeuds avec les threads de pool
+    //
+    //  Complexité O(n)
+    //
+    void clear(TaskPool& pool) noexcept {
+        deleteSubTreeParallel(_root, pool, 0);
+        _root = nullptr;
+    }
+
 private:
     //
     // @brief Fonction détruisant (delete) un sous arbre
@@ -173,7 +1066,7 @@ private:
     //
     //  Complexité: moy(n))
     //
-    static void deleteSubTree(Node* r) noexcept {
+    void deleteSubTree(Node* r) noexcept {
         if(r != nullptr) {
             if (r->left != nullptr) {
                 deleteSubTree(r->left);
@@ -181,11 +1074,214 @@ private:
             if (r->right != nullptr) {
                 deleteSubTree(r->right);
             }
-            delete (r);
+            destroyNode(r);
             r = nullptr;
         }
     }
 
+    //
+    // @brief Détruit un sous arbre en parcours post-ordonné sans récursion
+    //
+    // @param r la racine du sous arbre à détruire.
+    //          peut éventuellement valoir nullptr
+    //
+    // Les noeuds à détruire servent eux-mêmes de pile: en descendant, le
+    // pointeur left mémorise le parent et nbElements indique si le sous
+    // arbre droit a déjà été parcouru (inversion de pointeurs).
+    //
+    //  Complexité: O(n), mémoire supplémentaire O(1)
+    //
+    void deleteSubTreeIterative(Node* r) noexcept {
+        Node* stack = nullptr;
+        for(;;) {
+            while(r != nullptr) {
+                Node* next = r->left;
+                r->left = stack;
+                r->nbElements = 0;
+                stack = r;
+                r = next;
+            }
+            while(stack != nullptr && stack->nbElements != 0) {
+                Node* done = stack;
+                stack = done->left;
+                destroyNode(done);
+            }
+            if(stack == nullptr)
+                return;
+            stack->nbElements = 1;
+            r = stack->right;
+        }
+    }
+
+    //
+    // @brief Détruit un sous arbre, les grands sous arbres par des taches
+    //        séparées
+    //
+    // Le parallélisme n'est utilisé que si l'allocateur est threadSafe.
+    //
+    //  Complexité: O(n)
+    //
+    void deleteSubTreeParallel(Node* r, TaskPool& pool, size_t depth) noexcept {
+        if(!allocator_type::threadSafe || sizeOf(r) < copyGrain || depth == parallelMaxDepth) {
+            if(iterative)
+                deleteSubTreeIterative(r);
+            else if(r != nullptr)
+                deleteSubTree(r);
+            return;
+        }
+        Node* left = r->left;
+        Node* right = r->right;
+        destroyNode(r);
+        pool.invoke([&] { deleteSubTreeParallel(left, pool, depth + 1); },
+                    [&] { deleteSubTreeParallel(right, pool, depth + 1); });
+    }
+
+private:
+    static Node* leftmost(Node* r) noexcept {
+        while(r->left != nullptr)
+            r = r->left;
+        return r;
+    }
+
+    static Node* rightmost(Node* r) noexcept {
+        while(r->right != nullptr)
+            r = r->right;
+        return r;
+    }
+
+    //
+    // @brief noeud suivant / précédent dans l'ordre croissant
+    //
+    // @return nullptr s'il n'y en a pas
+    //
+    //  Complexité: O(1) amorti sur un parcours complet
+    //
+    static Node* successor(Node* r) noexcept {
+        if(r->right != nullptr)
+            return leftmost(r->right);
+        while(r->parent != nullptr && r->parent->right == r)
+            r = r->parent;
+        return r->parent;
+    }
+
+    static Node* predecessor(Node* r) noexcept {
+        if(r->left != nullptr)
+            return rightmost(r->left);
+        while(r->parent != nullptr && r->parent->left == r)
+            r = r->parent;
+        return r->parent;
+    }
+
+public:
+    //
+    // @brief Itérateur bidirectionnel parcourant les clés par ordre croissant
+    //
+    // Les clés ne sont pas modifiables: iterator et const_iterator sont le
+    // meme type. Un incrément suit les liens parent, sans allocation.
+    // Les itérateurs sont invalidés par toute modification de l'arbre.
+    //
+    class const_iterator {
+    public:
+        using iterator_category = bidirectional_iterator_tag;
+        using value_type = T;
+        using difference_type = ptrdiff_t;
+        using pointer = const T*;
+        using reference = const T&;
+
+        const_iterator() noexcept : node(nullptr), tree(nullptr) {
+        }
+
+        reference operator * () const noexcept {
+            return node->key;
+        }
+
+        pointer operator -> () const noexcept {
+            return &node->key;
+        }
+
+        const_iterator& operator ++ () noexcept {
+            node = successor(node);
+            return *this;
+        }
+
+        const_iterator operator ++ (int) noexcept {
+            const_iterator tmp = *this;
+            ++*this;
+            return tmp;
+        }
+
+        // --end() désigne la plus grande clé
+        const_iterator& operator -- () noexcept {
+            node = node != nullptr ? predecessor(node) : rightmost(tree->_root);
+            return *this;
+        }
+
+        const_iterator operator -- (int) noexcept {
+            const_iterator tmp = *this;
+            --*this;
+            return tmp;
+        }
+
+        bool operator == (const const_iterator& other) const noexcept {
+            return node == other.node;
+        }
+
+        bool operator != (const const_iterator& other) const noexcept {
+            return node != other.node;
+        }
+
+    private:
+        friend class BinarySearchTree;
+
+        const_iterator(Node* node, const BinarySearchTree* tree) noexcept
+                : node(node), tree(tree) {
+        }
+
+        Node* node;                   // nullptr pour end()
+        const BinarySearchTree* tree; // pour décrémenter end()
+    };
+
+    using iterator = const_iterator;
+    using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+    using reverse_iterator = const_reverse_iterator;
+
+    //
+    // @brief Bornes du parcours par ordre croissant
+    //
+    //  Complexité: begin() O(hauteur), end() O(1)
+    //
+    const_iterator begin() const noexcept {
+        return const_iterator(_root != nullptr ? leftmost(_root) : nullptr, this);
+    }
+
+    const_iterator end() const noexcept {
+        return const_iterator(nullptr, this);
+    }
+
+    const_iterator cbegin() const noexcept {
+        return begin();
+    }
+
+    const_iterator cend() const noexcept {
+        return end();
+    }
+
+    const_reverse_iterator rbegin() const noexcept {
+        return const_reverse_iterator(end());
+    }
+
+    const_reverse_iterator rend() const noexcept {
+        return const_reverse_iterator(begin());
+    }
+
+    const_reverse_iterator crbegin() const noexcept {
+        return rbegin();
+    }
+
+    const_reverse_iterator crend() const noexcept {
+        return rend();
+    }
+
 public:
     //
     // @brief Insertion d'une cle dans l'arbre
@@ -198,16 +1294,239 @@ public:
     //  Complexité: moy(log(n))
     //
     void insert( const_reference key) {
-        insert(_root,key);
+        insertKey(key, [&] { return createNode(key); });
+    }
+
+    //
+    // @brief Insertion d'une cle déplacée dans l'arbre
+    //
+    // La clé n'est déplacée dans un noeud qu'une fois sa place trouvée. Si
+    // elle est déjà présente, key n'est pas modifiée.
+    //
+    //  Complexité: moy(log(n))
+    //
+    void insert(value_type&& key) {
+        insertKey(key, [&] { return createNode(std::move(key)); });
+    }
+
+    //
+    // @brief Insertion d'une cle construite à partir de args
+    //
+    // @return vrai si la clé a été insérée, faux si elle était présente
+    //
+    // Une clé déjà construite est passée à insert, sans rien construire si
+    // elle est présente. Sinon la clé est construite directement dans son
+    // noeud, avant la descente qui a besoin d'elle, puis détruite si elle
+    // était déjà présente.
+    //
+    //  Complexité: moy(log(n))
+    //
+    template < typename... Args >
+    bool emplace(Args&&... args) {
+        if constexpr (sizeof...(Args) == 1 && (is_same<decay_t<Args>, value_type>::value && ...)) {
+            return insertKey(args..., [&] { return createNode(std::forward<Args>(args)...); });
+        } else {
+            Node* node = createNode(in_place, std::forward<Args>(args)...);
+            if(insertKey(node->key, [node] { return node; }))
+                return true;
+            destroyNode(node);
+            return false;
+        }
+    }
+
+    //
+    // @brief Choix de l'algorithme de insert_batch
+    //
+    enum class BatchMode {
+        Auto,    // selon les tailles du lot et de l'arbre
+        PerKey,  // une descente par clé
+        Merge    // linearize, fusion, arborize
+    };
+
+    //
+    // @brief Insertion d'un lot de cles
+    //
+    // @param first, last les cles a inserer, dans un ordre quelconque
+    // @param mode l'algorithme a utiliser
+    //
+    // Le lot est trié et dédoublonné. S'il est petit par rapport à
+    // l'arbre, chaque clé est insérée par une descente. Sinon l'arbre est
+    // linéarisé, fusionné avec le lot puis arborisé en une passe.
+    // Garantie forte en cas d'exception.
+    //
+    //  Complexité: O(m log(m) + min(m log(n), n + m))
+    //
+    template < typename InputIt >
+    void insert_batch(InputIt first, InputIt last, BatchMode mode = BatchMode::Auto) {
+        vector<value_type> batch(first, last);
+        sort(batch.begin(), batch.end(), _comp);
+        batch.erase(unique(batch.begin(), batch.end(),
+                           [this](const_reference a, const_reference b) { return !_comp(a, b); }),
+                    batch.end());
+
+        if(mode == BatchMode::Auto)
+            mode = mergeIsCheaper(size(), batch.size()) ? BatchMode::Merge : BatchMode::PerKey;
+
+        if(mode == BatchMode::PerKey) {
+            size_t i = 0;
+            vector<bool> inserted(batch.size());
+            try {
+                for(; i < batch.size(); ++i)
+                    inserted[i] = insertKey(batch[i], [&] { return createNode(batch[i]); });
+            } catch(...) {
+                while(i-- > 0)
+                    if(inserted[i])
+                        deleteElement(batch[i]);
+                throw;
+            }
+        } else
+            mergeSorted(std::move(batch));
+    }
+
+private:
+    //
+    // La fusion parcourt les n + m noeuds deux fois dans l'ordre des clés,
+    // alors que les premiers niveaux des descentes restent en cache.
+    // Mesuré avec bench.cpp (mesure batch, n = 10^6): la fusion ne devient
+    // plus rapide que pour m proche de n, soit m * log2(n) >= 8 * (n + m).
+    //
+    static constexpr size_t batchMergeFactor = 8;
+
+    static bool mergeIsCheaper(size_t n, size_t m) noexcept {
+        size_t depth = 1;
+        while((size_t(1) << depth) <= n)
+            ++depth;
+        return m * depth >= batchMergeFactor * (n + m);
+    }
+
+    //
+    // @brief Fusionne un lot trié sans doublons avec l'arbre
+    //
+    // Les noeuds du lot sont créés avant de toucher l'arbre, en y déplaçant
+    // les clés. Les clés déjà présentes sont détruites pendant la fusion.
+    //
+    //  Complexité: O(n + m)
+    //
+    void mergeSorted(vector<value_type>&& batch) {
+        vector<Node*> nodes;
+        nodes.reserve(batch.size());
+        try {
+            for(reference key : batch)
+                nodes.push_back(createNode(std::move(key)));
+        } catch(...) {
+            for(Node* node : nodes)
+                destroyNode(node);
+            throw;
+        }
+
+        size_t cnt = 0;
+        Node* list = nullptr;
+        if constexpr (iterative)
+            linearizeIterative(_root, list, cnt);
+        else
+            linearize(_root, list, cnt);
+
+        Node* merged = nullptr;
+        Node** tail = &merged;
+        size_t total = 0;
+        for(size_t i = 0; list != nullptr || i < nodes.size(); ) {
+            Node* next;
+            if(i == nodes.size() || (list != nullptr && _comp(list->key, nodes[i]->key))) {
+                next = list;
+                list = list->right;
+            } else if(list == nullptr || _comp(nodes[i]->key, list->key))
+                next = nodes[i++];
+            else {
+                destroyNode(nodes[i++]);
+                continue;
+            }
+            *tail = next;
+            tail = &next->right;
+            ++total;
+        }
+        *tail = nullptr;
+
+        if constexpr (iterative)
+            arborizeIterative(_root, merged, total);
+        else
+            arborize(_root, merged, total);
+        if(_root != nullptr)
+            _root->parent = nullptr;
     }
 
 private:
+    //
+    // @brief Insertion d'une cle, dont le noeud est fourni par make
+    //
+    // @param key la clé, utilisée pour la descente
+    // @param make appelée une seule fois, quand la place de key est trouvée
+    //        et si elle est absente. Rend le noeud à insérer.
+    //
+    template < typename Make >
+    bool insertKey(const_reference key, Make make) {
+        Path path;
+        Node* added = nullptr;
+        auto track = [&] { return added = make(); };
+        bool inserted;
+        if constexpr (iterativeUpdates)
+            inserted = insertIterative(key, track, path);
+        else
+            inserted = insert(_root, key, track, path);
+        Stats::record(TreeOperation::insert, path);
+        if constexpr (isAutoBalanced<Balancing>::value)
+            if(inserted)
+                autoBalance(added);
+        return inserted;
+    }
+
+    //
+    // @brief Rééquilibre l'arbre si le noeud n, qui vient d'etre inséré,
+    //        est trop profond selon AutoBalancing
+    //
+    // Le sous arbre reconstruit est celui du premier ancetre a de n tel
+    // que le chemin de a à n soit trop long pour la taille de a, et qu'une
+    // fois a reconstruit, n ne soit plus trop profond. La racine convient
+    // toujours quand le rééquilibrage est déclenché.
+    //
+    //  Complexité: O(profondeur de n), plus O(taille du sous arbre
+    //  reconstruit)
+    //
+    void autoBalance(Node* n) noexcept {
+        size_t depth = 0;
+        for(Node* r = n; r != nullptr; r = r->parent)
+            ++depth;
+        size_t total = sizeOf(_root);
+        if(!Balancing::triggers(depth, total))
+            return;
+
+        auto start = Balancing::Clock::now();
+        if(Balancing::rebuildsWholeTree()) {
+            balance();
+            Balancing::rebalanced(depth, total, total, start);
+            return;
+        }
+        double limit = Balancing::maxHeight(total);
+        Node* a = n;
+        size_t d = 1; // noeuds de a à n
+        while(a->parent != nullptr && (double(d) <= Balancing::maxHeight(a->nbElements)
+                                       || double(depth - d + balancedHeight(a->nbElements)) > limit)) {
+            a = a->parent;
+            ++d;
+        }
+        Node* parent = a->parent;
+        Node*& slot = parent == nullptr ? _root : parent->left == a ? parent->left : parent->right;
+        rebuild(slot);
+        Balancing::rebalanced(depth, total, slot->nbElements, start);
+    }
+
     //
     // @brief Insertion d'une cle dans un sous-arbre
     //
     // @param r la racine du sous-arbre dans lequel
     //          insérer la cle.
     // @param key la clé à insérer.
+    // @param make crée le noeud de key, voir insertKey
+    // @param path compte les noeuds visités
     //
     // @return vrai si la cle est inseree. faux si elle etait deja presente.
     //
@@ -217,24 +1536,29 @@ private:
     //
     //  Complexité: moy(log(n))
     //
-    static bool insert(Node*& r, const_reference key) {
+    template < typename Make >
+    bool insert(Node*& r, const_reference key, Make& make, Path& path) {
 
         if(r == nullptr) {
-            r = new Node(key);
+            r = make();
             return true;
         }
 
-        else if (key < r->key) {
-            bool inserted = insert(r->left, key);
-            //addition du nombre d'éléments des deux enfants
-            r->nbElements = 1 + (r->left ? r->left->nbElements : 0) + (r->right ? r->right->nbElements : 0);
+        path.compare();
+        int c = compareKeys(key, r->key);
+        if (c < 0) {
+            bool inserted = insert(r->left, key, make, path);
+            //addition du nombre d'éléments des deux enfants et rotations
+            if(inserted)
+                rebalance(r);
             return inserted;
         }
 
-        else if (key > r->key) {
-            bool inserted = insert(r->right, key);
-            //addition du nombre d'éléments des deux enfants
-            r->nbElements = 1 +  (r->left ? r->left->nbElements : 0) + (r->right ? r->right->nbElements : 0);
+        else if (c > 0) {
+            bool inserted = insert(r->right, key, make, path);
+            //addition du nombre d'éléments des deux enfants et rotations
+            if(inserted)
+                rebalance(r);
             return inserted;
         }
 
@@ -243,6 +1567,57 @@ private:
 
     }
 
+    //
+    // @brief Insertion d'une cle sans récursion
+    //
+    // nbElements est incrémenté en descendant. Si la clé est déjà présente
+    // ou si la création du noeud échoue, un second parcours annule ces
+    // incréments. Ce dernier remonte par les parents: make a pu déplacer
+    // la clé.
+    //
+    //  Complexité: moy(log(n))
+    //
+    template < typename Make >
+    bool insertIterative(const_reference key, Make& make, Path& path) {
+        Node** slot = &_root;
+        Node* parent = nullptr;
+        while(*slot != nullptr) {
+            Node* r = parent = *slot;
+            path.compare();
+            int c = compareKeys(key, r->key);
+            if(c < 0) {
+                ++r->nbElements;
+                slot = &r->left;
+            } else if(c > 0) {
+                ++r->nbElements;
+                slot = &r->right;
+            } else {
+                undoCounts(key, r, -1);
+                return false;
+            }
+        }
+
+        try {
+            *slot = make();
+            (*slot)->parent = parent;
+        } catch(...) {
+            for(Node* r = parent; r != nullptr; r = r->parent)
+                --r->nbElements;
+            throw;
+        }
+        return true;
+    }
+
+    //
+    // @brief Ajoute delta à nbElements sur le chemin de key, de la racine
+    //        jusqu'au noeud stop exclu
+    //
+    template < typename K >
+    void undoCounts(const K& key, Node* stop, int delta) noexcept {
+        for(Node* r = _root; r != stop; r = _comp(key, r->key) ? r->left : r->right)
+            r->nbElements += delta;
+    }
+
 public:
     //
     // @brief Recherche d'une cle.
@@ -257,35 +1632,76 @@ public:
     //  Complexité moy(log(n))
     //
     bool contains( const_reference key ) const noexcept {
-        return contains(_root,key);
+        return containsKey(key);
+    }
+
+    //
+    // @brief Recherche d'une cle d'un autre type, si Compare est
+    //        transparent
+    //
+    template < typename K, ifTransparent<K> = 0 >
+    bool contains(const K& key) const noexcept {
+        return containsKey(key);
     }
 
 private:
+    template < typename K >
+    bool containsKey(const K& key) const noexcept {
+        Path path;
+        bool found;
+        if constexpr (iterative)
+            found = containsIterative(key, path);
+        else
+            found = contains(_root, key, path);
+        Stats::record(TreeOperation::contains, path);
+        return found;
+    }
+
     //
     // @brief Recherche d'une cle dans un sous-arbre
     //
     // @param key la cle a rechercher
     // @param r   la racine du sous-arbre
+    // @param path compte les noeuds visités
     //
     // @return vrai si la cle trouvee, faux sinon.
     //
     //  Complexité moy(log(n))
     //
-    static bool contains(Node* r, const_reference key) noexcept {
+    template < typename K >
+    bool contains(Node* r, const K& key, Path& path) const noexcept {
 
         if(r == nullptr)
             return false;
 
-        else if(key < r->key)
-            return contains(r->left, key);
+        path.compare();
+        int c = compareKeys(key, r->key);
+        if(c < 0)
+            return contains(r->left, key, path);
 
-        else if(key > r->key)
-            return contains(r->right, key);
+        else if(c > 0)
+            return contains(r->right, key, path);
 
         else
             return true;
     }
 
+    template < typename K >
+    bool containsIterative(const K& key, Path& path) const noexcept {
+        Node* r = _root;
+        while(r != nullptr) {
+            path.compare();
+            int c = compareKeys(key, r->key);
+            if(c < 0)
+                r = r->left;
+            else if(c > 0)
+                r = r->right;
+            else
+                return true;
+        }
+        return false;
+    }
+
 public:
     //
     // @brief Recherche de la cle minimale.
@@ -319,7 +1735,13 @@ public:
     //
 
     void deleteMin() {
-        delete deleteMinAndReturnIt(_root);
+        if(_root == nullptr)
+            throw logic_error("empty tree");
+
+        if constexpr (iterativeUpdates)
+            destroyNode(deleteMinIterative(_root));
+        else
+            destroyNode(deleteMinAndReturnIt(_root));
     }
 
 
@@ -336,10 +1758,31 @@ public:
     // récursive privée deleteElement(Node*&,const_reference)
     //
     bool deleteElement( const_reference key) noexcept {
-        return deleteElement( _root, key );
+        return deleteKey(key);
+    }
+
+    //
+    // @brief Suppression par une cle d'un autre type, si Compare est
+    //        transparent
+    //
+    template < typename K, ifTransparent<K> = 0 >
+    bool deleteElement(const K& key) noexcept {
+        return deleteKey(key);
     }
 
 private:
+    template < typename K >
+    bool deleteKey(const K& key) noexcept {
+        Path path;
+        bool deleted;
+        if constexpr (iterativeUpdates)
+            deleted = deleteElementIterative( key, path );
+        else
+            deleted = deleteElement( _root, key, path );
+        Stats::record(TreeOperation::deleteElement, path);
+        return deleted;
+    }
+
     //
     // @brief Supprime l'element de cle key du sous arbre.
     //
@@ -365,40 +1808,52 @@ private:
    /**
     * @brief Enleve et retourne le plus petit élément de l'arbre
     * 
-    * @param r la racine du sous arbre
-    * @return l'element minimum supprimé
+    * @param r la racine du sous arbre. ne peut pas etre nullptr
+    * @param path compte les noeuds visités
+    * @return l'element minimum, détaché de l'arbre
     * 
     * Complexité : O(log(n))
     */    
-    static Node* deleteMinAndReturnIt(Node* r) {
-        if(r == nullptr)
-            throw logic_error("empty tree");
-
-        Node* min = r;
-        Node* tmp = nullptr;
-
-        r->nbElements--;
-        //le minimum est la racine
-        if(min->left == nullptr){
-            tmp = min;
-            return tmp;
+    static Node* deleteMinAndReturnIt(Node*& r, Path& path) noexcept {
+        path.visit();
+        if(r->left == nullptr) {
+            Node* min = r;
+            r = r->right;
+            if(r != nullptr)
+                r->parent = min->parent;
+            min->right = nullptr;
+            return min;
         }
 
-        // minEl est l'avant plus petit
-        while(min->left->left != nullptr){
-            min = min->left;
-            min->nbElements--;
-        }
+        Node* min = deleteMinAndReturnIt(r->left, path);
+        rebalance(r);
+        return min;
+    }
 
-        tmp = min->left;
-        min->left = min->left->right;
-        if (tmp->right != nullptr) {
-            min->left = tmp->right;
-        } else {
-            tmp->left = nullptr;
+    static Node* deleteMinAndReturnIt(Node*& r) noexcept {
+        Path path;
+        return deleteMinAndReturnIt(r, path);
+    }
+
+    static Node* deleteMinIterative(Node*& r, Path& path) noexcept {
+        Node** slot = &r;
+        path.visit();
+        while((*slot)->left != nullptr) {
+            --(*slot)->nbElements;
+            slot = &(*slot)->left;
+            path.visit();
         }
+        Node* min = *slot;
+        *slot = min->right;
+        if(*slot != nullptr)
+            (*slot)->parent = min->parent;
+        min->right = nullptr;
+        return min;
+    }
 
-        return tmp;
+    static Node* deleteMinIterative(Node*& r) noexcept {
+        Path path;
+        return deleteMinIterative(r, path);
     }
 
 
@@ -422,56 +1877,103 @@ private:
     * 
     * @param r la racine du sous arbre
     * @param key valeur à supprimer 
+    * @param path compte les noeuds visités
     * @return true si la suppression s'est effectuée correctement
     * 
     * Complexité : O(log(n))
     */      
-    static bool deleteElement( Node*& r, const_reference key) noexcept {
+    template < typename K >
+    bool deleteElement( Node*& r, const K& key, Path& path) noexcept {
 
         if(r == nullptr)
             return false;
 
-        if(r->key > key) {
-            bool deleted = deleteElement(r->left, key);
+        path.compare();
+        int c = compareKeys(key, r->key);
+        if(c < 0) {
+            bool deleted = deleteElement(r->left, key, path);
             if (deleted) {
-                r->nbElements--;
+                rebalance(r);
             }
             return deleted;
         }
 
-        else if(r->key < key) {
-            bool deleted = deleteElement(r->right, key);
+        else if(c > 0) {
+            bool deleted = deleteElement(r->right, key, path);
             if(deleted){
-                r->nbElements--;
+                rebalance(r);
             }
             return deleted;
         }
         else{ // key found
             Node* tmp = r;
             if(r->right == nullptr) {
-                tmp = r->left;
-                delete r;
-                r = tmp;
+                r = r->left;
             }
             else if(r->left == nullptr){
-                tmp = r->right;
-                delete r;
-                r = tmp;
+                r = r->right;
             } // use Hibbard
             else {
-                Node* min = deleteMinAndReturnIt(r->right);
-                min->nbElements = tmp->nbElements -1;
-                r = min;
-                tmp->right->left = min->right;
-                min->right = tmp->right;
+                Node* min = deleteMinAndReturnIt(r->right, path);
                 min->left = tmp->left;
-                delete tmp;
-                tmp = nullptr;
+                min->right = tmp->right;
+                r = min;
+                rebalance(r);
             }
+            if(r != nullptr)
+                r->parent = tmp->parent;
+            destroyNode(tmp);
             return true;
         }
     }
 
+    //
+    // @brief Suppression sans récursion
+    //
+    // nbElements est décrémenté en descendant. Si la clé est absente, un
+    // second parcours rétablit les compteurs.
+    //
+    //  Complexité : moy(log(n))
+    //
+    template < typename K >
+    bool deleteElementIterative( const K& key, Path& path) noexcept {
+        Node** slot = &_root;
+        for(;;) {
+            Node* r = *slot;
+            if(r == nullptr) {
+                undoCounts(key, nullptr, 1);
+                return false;
+            }
+            path.compare();
+            int c = compareKeys(key, r->key);
+            if(c < 0) {
+                --r->nbElements;
+                slot = &r->left;
+            } else if(c > 0) {
+                --r->nbElements;
+                slot = &r->right;
+            } else
+                break;
+        }
+
+        Node* tmp = *slot;
+        if(tmp->right == nullptr)
+            *slot = tmp->left;
+        else if(tmp->left == nullptr)
+            *slot = tmp->right;
+        else { // use Hibbard
+            Node* min = deleteMinIterative(tmp->right, path);
+            min->left = tmp->left;
+            min->right = tmp->right;
+            update(min);
+            *slot = min;
+        }
+        if(*slot != nullptr)
+            (*slot)->parent = tmp->parent;
+        destroyNode(tmp);
+        return true;
+    }
+
 public:
     //
     // @brief taille de l'arbre
@@ -487,6 +1989,40 @@ public:
         return _root->nbElements;
     }
 
+    //
+    // @brief hauteur de l'arbre, 0 s'il est vide
+    //
+    // Avec AVLBalancing, la hauteur est lue à la racine. Sinon l'arbre est
+    // parcouru par les liens parent, sans pile.
+    //
+    //  Complexité: O(1) avec AVLBalancing, O(n) sinon
+    //
+    size_t height() const noexcept {
+        if constexpr (is_same<Balancing, AVLBalancing>::value)
+            return size_t(heightOf(_root));
+        else {
+            size_t h = 0;
+            size_t depth = 0;
+            Node* from = nullptr;
+            Node* r = _root;
+            while(r != nullptr) {
+                Node* next;
+                if(from == r->parent) { // première visite de r
+                    h = std::max(h, ++depth);
+                    next = r->left != nullptr ? r->left : r->right != nullptr ? r->right : r->parent;
+                } else if(from == r->left && r->right != nullptr)
+                    next = r->right;
+                else
+                    next = r->parent;
+                if(next == r->parent)
+                    --depth;
+                from = r;
+                r = next;
+            }
+            return h;
+        }
+    }
+
     // @brief cle en position n
     //
     // @return une reference a la cle en position n par ordre croissant des
@@ -505,7 +2041,10 @@ public:
         } else if(n > size()){
             throw logic_error("Erreur: La position est en dehors du tableau.");
         }
-        return nth_element(_root,n);
+        Path path;
+        const_reference key = iterative ? nthElementIterative(n, path) : nth_element(_root, n, path);
+        Stats::record(TreeOperation::nthElement, path);
+        return key;
     }
 
 private:
@@ -514,13 +2053,15 @@ private:
     //
     // @param r la racine du sous arbre. ne peut pas etre nullptr
     // @param n la position n
+    // @param path compte les noeuds visités
     //
     // @return une reference a la cle en position n par ordre croissant des
     // elements
     //
     //  Complexité: O(n)
     //
-    static const_reference nth_element(Node* r, size_t n) noexcept {
+    static const_reference nth_element(Node* r, size_t n, Path& path) noexcept {
+        path.visit();
         size_t s;
         if(r->left == nullptr){
             s = 0;
@@ -528,14 +2069,29 @@ private:
             s = r->left->nbElements;
         }
         if(n < s){
-            return nth_element(r->left,n);
+            return nth_element(r->left,n,path);
         } else if(n > s){
-            return nth_element(r->right,n-s-1);
+            return nth_element(r->right,n-s-1,path);
         } else {
             return r->key;
         }
     }
 
+    const_reference nthElementIterative(size_t n, Path& path) const noexcept {
+        Node* r = _root;
+        for(;;) {
+            path.visit();
+            size_t s = sizeOf(r->left);
+            if(n < s)
+                r = r->left;
+            else if(n > s) {
+                n -= s + 1;
+                r = r->right;
+            } else
+                return r->key;
+        }
+    }
+
 public:
     //
     // @brief position d'une cle dans l'ordre croissant des elements de l'arbre
@@ -547,31 +2103,56 @@ public:
     // Ne pas modifier mais écrire la fonction
     // récursive privée rank(Node*,const_reference)
     //
-    //  Compléxité moy O(log(n))
-    //      
-    size_t rank(const_reference key) const noexcept {
-        return rank(_root,key);
+    //  Compléxité moy O(log(n))
+    //      
+    size_t rank(const_reference key) const noexcept {
+        return rankKey(key);
+    }
+
+    //
+    // @brief position d'une cle d'un autre type, si Compare est
+    //        transparent
+    //
+    template < typename K, ifTransparent<K> = 0 >
+    size_t rank(const K& key) const noexcept {
+        return rankKey(key);
     }
 
 private:
+    template < typename K >
+    size_t rankKey(const K& key) const noexcept {
+        Path path;
+        size_t position;
+        if constexpr (iterative)
+            position = rankIterative(key, path);
+        else
+            position = rank(_root, key, path);
+        Stats::record(TreeOperation::rank, path);
+        return position;
+    }
+
     //
     // @brief position d'une cle dans l'ordre croissant des elements du sous-arbre
     //
     // @param key la cle dont on cherche le rang
     // @param r la racine du sous arbre
+    // @param path compte les noeuds visités
     //
     // @return la position entre 0 et size()-1, size_t(-1) si la cle est absente
     //
     //  Complexité moy O(log(n))
     //  
-    static size_t rank(Node* r, const_reference key) noexcept {
+    template < typename K >
+    size_t rank(Node* r, const K& key, Path& path) const noexcept {
         if(r == nullptr)
             return -1;
-        else if(key < r->key)
-            return rank(r->left, key);
-        else if(key > r->key) {
+        path.compare();
+        int c = compareKeys(key, r->key);
+        if(c < 0)
+            return rank(r->left, key, path);
+        else if(c > 0) {
             size_t rank_l = 0;
-            size_t rank_r = rank(r->right, key);
+            size_t rank_r = rank(r->right, key, path);
             if(rank_r == -1)
                 return -1;
             if(r->left != nullptr)
@@ -585,6 +2166,198 @@ private:
         }
     }
 
+    template < typename K >
+    size_t rankIterative(const K& key, Path& path) const noexcept {
+        size_t before = 0;
+        Node* r = _root;
+        while(r != nullptr) {
+            path.compare();
+            int c = compareKeys(key, r->key);
+            if(c < 0)
+                r = r->left;
+            else if(c > 0) {
+                before += sizeOf(r->left) + 1;
+                r = r->right;
+            } else
+                return before + sizeOf(r->left);
+        }
+        return -1;
+    }
+
+public:
+    //
+    // @brief nombre de cles strictement inferieures a key
+    //
+    // @param key une cle, presente ou non dans l'arbre
+    //
+    // @return rank(key) si la cle est presente, sinon la position a laquelle
+    //         elle serait inseree
+    //
+    //  Complexité: O(hauteur)
+    //
+    size_t insertionRank(const_reference key) const noexcept {
+        return insertionRankOf(key);
+    }
+
+    template < typename K, ifTransparent<K> = 0 >
+    size_t insertionRank(const K& key) const noexcept {
+        return insertionRankOf(key);
+    }
+
+    //
+    // @brief Recherches de la cle la plus proche
+    //
+    // @param key une cle, presente ou non dans l'arbre, éventuellement d'un
+    //        autre type si Compare est transparent
+    //
+    // @return lower_bound: la plus petite cle >= key
+    //         upper_bound: la plus petite cle > key
+    //         floor:       la plus grande cle <= key
+    //         ceiling:     la plus petite cle >= key
+    //         end() si une telle cle n'existe pas
+    //
+    //  Complexité: O(hauteur)
+    //
+    const_iterator lower_bound(const_reference key) const noexcept {
+        return lowerBound(key);
+    }
+
+    template < typename K, ifTransparent<K> = 0 >
+    const_iterator lower_bound(const K& key) const noexcept {
+        return lowerBound(key);
+    }
+
+    const_iterator upper_bound(const_reference key) const noexcept {
+        return upperBound(key);
+    }
+
+    template < typename K, ifTransparent<K> = 0 >
+    const_iterator upper_bound(const K& key) const noexcept {
+        return upperBound(key);
+    }
+
+    const_iterator floor(const_reference key) const noexcept {
+        return floorOf(key);
+    }
+
+    template < typename K, ifTransparent<K> = 0 >
+    const_iterator floor(const K& key) const noexcept {
+        return floorOf(key);
+    }
+
+    const_iterator ceiling(const_reference key) const noexcept {
+        return lowerBound(key);
+    }
+
+    template < typename K, ifTransparent<K> = 0 >
+    const_iterator ceiling(const K& key) const noexcept {
+        return lowerBound(key);
+    }
+
+    //
+    // @brief nombre de cles dans l'intervalle [lo, hi)
+    //
+    // @param lo borne inferieure incluse, presente ou non dans l'arbre
+    // @param hi borne superieure exclue, presente ou non dans l'arbre
+    //
+    //  Complexité: O(hauteur)
+    //
+    size_t count_range(const_reference lo, const_reference hi) const noexcept {
+        return countRange(lo, hi);
+    }
+
+    template < typename K, ifTransparent<K> = 0 >
+    size_t count_range(const K& lo, const K& hi) const noexcept {
+        return countRange(lo, hi);
+    }
+
+    //
+    // @brief Parcours par ordre croissant des cles de l'intervalle [lo, hi)
+    //
+    // @param f une fonction capable d'être appelée en recevant une cle
+    //          en parametre.
+    //
+    //  Complexité: O(hauteur + k) pour k cles visitees
+    //
+    template < typename Fn >
+    void visit_range(const_reference lo, const_reference hi, Fn f) const {
+        visitRange(lo, hi, f);
+    }
+
+    template < typename K, typename Fn, ifTransparent<K> = 0 >
+    void visit_range(const K& lo, const K& hi, Fn f) const {
+        visitRange(lo, hi, f);
+    }
+
+private:
+    template < typename K >
+    size_t insertionRankOf(const K& key) const noexcept {
+        size_t before = 0;
+        Node* r = _root;
+        while(r != nullptr) {
+            if(_comp(r->key, key)) {
+                before += sizeOf(r->left) + 1;
+                r = r->right;
+            } else
+                r = r->left;
+        }
+        return before;
+    }
+
+    template < typename K >
+    const_iterator lowerBound(const K& key) const noexcept {
+        Node* best = nullptr;
+        for(Node* r = _root; r != nullptr; ) {
+            if(_comp(r->key, key))
+                r = r->right;
+            else {
+                best = r;
+                r = r->left;
+            }
+        }
+        return const_iterator(best, this);
+    }
+
+    template < typename K >
+    const_iterator upperBound(const K& key) const noexcept {
+        Node* best = nullptr;
+        for(Node* r = _root; r != nullptr; ) {
+            if(_comp(key, r->key)) {
+                best = r;
+                r = r->left;
+            } else
+                r = r->right;
+        }
+        return const_iterator(best, this);
+    }
+
+    template < typename K >
+    const_iterator floorOf(const K& key) const noexcept {
+        Node* best = nullptr;
+        for(Node* r = _root; r != nullptr; ) {
+            if(_comp(key, r->key))
+                r = r->left;
+            else {
+                best = r;
+                r = r->right;
+            }
+        }
+        return const_iterator(best, this);
+    }
+
+    template < typename K >
+    size_t countRange(const K& lo, const K& hi) const noexcept {
+        if(!_comp(lo, hi))
+            return 0;
+        return insertionRankOf(hi) - insertionRankOf(lo);
+    }
+
+    template < typename K, typename Fn >
+    void visitRange(const K& lo, const K& hi, Fn& f) const {
+        for(const_iterator it = lowerBound(lo); it != end() && _comp(*it, hi); ++it)
+            f(*it);
+    }
+
 public:
     //
     // @brief linearise l'arbre
@@ -603,8 +2376,13 @@ public:
     void linearize() noexcept {
         size_t cnt = 0;
         Node* list = nullptr;
-        linearize(_root,list,cnt);
+        if constexpr (iterative)
+            linearizeIterative(_root,list,cnt);
+        else
+            linearize(_root,list,cnt);
         _root = list;
+        if(_root != nullptr)
+            _root->parent = nullptr;
     }
 
 private:
@@ -637,7 +2415,47 @@ private:
         linearize(tree->left, list,cnt);
 
         tree->left = nullptr;
+        update(tree);
+
+    }
+
+    //
+    // @brief linearise un sous arbre sans récursion
+    //
+    // Les rotations droites successives transforment tree en une liste
+    // (tree-to-vine de Day-Stout-Warren), chainée ensuite devant list.
+    // Memes parametres et meme résultat que linearize.
+    //
+    //  Complexité: O(n), mémoire supplémentaire O(1)
+    //
+    static void linearizeIterative(Node* tree, Node*& list, size_t& cnt) noexcept {
+        if(tree == nullptr)
+            return;
 
+        size_t n = tree->nbElements;
+        Node** slot = &tree;
+        while(*slot != nullptr) {
+            Node* r = *slot;
+            if(r->left != nullptr) {
+                Node* l = r->left;
+                r->left = l->right;
+                l->right = r;
+                *slot = l;
+            } else
+                slot = &r->right;
+        }
+        *slot = list;
+
+        cnt += n;
+        size_t position = cnt;
+        for(Node* r = tree; r != list; r = r->right) {
+            if(r->right != nullptr)
+                r->right->parent = r;
+            r->nbElements = position--;
+            if constexpr (is_same<Balancing, AVLBalancing>::value)
+                r->height = int(r->nbElements);
+        }
+        list = tree;
     }
 
 public:
@@ -652,10 +2470,100 @@ public:
     //  Complexité: O(n)
     //  
     void balance() noexcept {
+        auto timer = Stats::startTimer();
         size_t cnt = 0;
         Node* list = nullptr;
-        linearize(_root,list,cnt);
-        arborize(_root,list,cnt);
+        if constexpr (iterative) {
+            linearizeIterative(_root,list,cnt);
+            arborizeIterative(_root,list,cnt);
+        } else {
+            linearize(_root,list,cnt);
+            arborize(_root,list,cnt);
+        }
+        if(_root != nullptr)
+            _root->parent = nullptr;
+        Stats::balanced(timer);
+    }
+
+    //
+    // @brief equilibre l'arbre en parallèle
+    //
+    // @param pool les threads effectuant le travail
+    //
+    // nbElements donne le rang de chaque noeud: les noeuds sont rangés par
+    // rang dans un tableau, chaque grand sous arbre par une tache séparée,
+    // puis l'arbre est reconstruit depuis le tableau, chaque moitié par une
+    // tache séparée. L'arbre obtenu a exactement la forme que lui donne
+    // balance(). Si le tableau ne peut pas etre alloué, balance() est
+    // appelée.
+    //
+    //  Complexité: O(n), profondeur O(log(n)) si l'arbre est équilibré,
+    //  mémoire supplémentaire O(n)
+    //
+    void balance(TaskPool& pool) noexcept {
+        size_t n = sizeOf(_root);
+        vector<Node*> nodes;
+        try {
+            nodes.resize(n);
+        } catch(const bad_alloc&) {
+            balance();
+            return;
+        }
+        auto timer = Stats::startTimer();
+        bool parallel = pool.concurrency() > 1;
+        gatherByRank(_root, nodes.data(), pool, parallel, 0);
+        _root = buildByRank(nodes.data(), n, pool, parallel);
+        if(_root != nullptr)
+            _root->parent = nullptr;
+        Stats::balanced(timer);
+    }
+
+private:
+    // taille minimale d'un sous arbre traité par une tache séparée
+    static constexpr size_t balanceGrain = size_t(1) << 15;
+
+    //
+    // @brief Range les noeuds du sous arbre r par ordre croissant dans out
+    //
+    // Un petit sous arbre est parcouru sans récursion, par successor.
+    //
+    static void gatherByRank(Node* r, Node** out, TaskPool& pool, bool parallel, size_t depth) noexcept {
+        if(r == nullptr)
+            return;
+        size_t leftSize = sizeOf(r->left);
+        if(parallel && depth < parallelMaxDepth
+           && leftSize >= balanceGrain && sizeOf(r->right) >= balanceGrain) {
+            out[leftSize] = r;
+            pool.invoke([&] { gatherByRank(r->left, out, pool, parallel, depth + 1); },
+                        [&] { gatherByRank(r->right, out + leftSize + 1, pool, parallel, depth + 1); });
+            return;
+        }
+        Node* node = leftmost(r);
+        for(size_t i = 0, n = r->nbElements; i < n; ++i) {
+            out[i] = node;
+            node = successor(node);
+        }
+    }
+
+    //
+    // @brief Construit l'arbre des cnt noeuds de nodes, de meme forme
+    //        qu'arborize
+    //
+    static Node* buildByRank(Node** nodes, size_t cnt, TaskPool& pool, bool parallel) noexcept {
+        if(cnt == 0)
+            return nullptr;
+        size_t leftCnt = (cnt - 1) / 2;
+        Node* root = nodes[leftCnt];
+        auto left = [&] { root->left = buildByRank(nodes, leftCnt, pool, parallel); };
+        auto right = [&] { root->right = buildByRank(nodes + leftCnt + 1, cnt / 2, pool, parallel); };
+        if(parallel && cnt >= 2 * balanceGrain)
+            pool.invoke(left, right);
+        else {
+            left();
+            right();
+        }
+        update(root);
+        return root;
     }
 
 private:
@@ -688,11 +2596,540 @@ private:
         }
 
         tree = middleNode;
-        tree->nbElements = cnt;
         arborize(tree->left, list, (cnt-1)/2);
         list = middleNode->right;
         arborize(tree->right, list, cnt/2);
+        update(tree);
+
+    }
+
+    //
+    // @brief arborise sans récursion les cnt premiers elements d'une liste
+    //
+    // Memes parametres et meme forme d'arbre que arborize. Les noeuds sont
+    // consommés dans l'ordre de la liste, la pile explicite a une hauteur
+    // de log2(cnt) + 2 au plus.
+    //
+    //  Complexité: O(n)
+    //
+    static void arborizeIterative(Node*& tree, Node*& list, size_t cnt) noexcept {
+        struct Frame {
+            Node** slot;  // ou écrire la racine du sous arbre
+            size_t cnt;   // nombre d'elements du sous arbre
+            Node* left;   // sous arbre gauche, une fois construit
+            Node* root;   // racine, prise en tete de liste apres la gauche
+            int state;    // 0: a commencer, 1: gauche construit, 2: fini
+        };
+        Frame stack[2 + 8 * sizeof(size_t)];
+        size_t top = 0;
+        stack[top++] = { &tree, cnt, nullptr, nullptr, 0 };
+
+        while(top != 0) {
+            Frame& f = stack[top - 1];
+            if(f.state == 0) {
+                if(list == nullptr || f.cnt == 0) {
+                    *f.slot = nullptr;
+                    --top;
+                } else {
+                    f.state = 1;
+                    stack[top++] = { &f.left, (f.cnt - 1) / 2, nullptr, nullptr, 0 };
+                }
+            } else if(f.state == 1) {
+                f.root = list;
+                list = list->right;
+                f.root->left = f.left;
+                f.state = 2;
+                stack[top++] = { &f.root->right, f.cnt / 2, nullptr, nullptr, 0 };
+            } else {
+                update(f.root);
+                *f.slot = f.root;
+                --top;
+            }
+        }
+    }
+
+public:
+    //
+    // @brief Sépare l'arbre selon une clé
+    //
+    // @param key la clé de séparation, presente ou non dans l'arbre
+    //
+    // @return les arbres des clés < key et des clés >= key. Les noeuds
+    //         sont déplacés, sans copie. L'arbre courant est vidé.
+    //
+    //  Complexité: O(hauteur)
+    //
+    pair<BinarySearchTree, BinarySearchTree> split(const_reference key) noexcept {
+        return splitBy([this, &key](Node* r) { return _comp(r->key, key) ? -1 : 1; });
+    }
+
+    //
+    // @brief Sépare l'arbre selon un rang
+    //
+    // @param rank le nombre de clés de l'arbre de gauche
+    //
+    // @return les arbres des rank plus petites clés et des autres clés.
+    //         L'arbre courant est vidé.
+    //
+    //  Complexité: O(hauteur)
+    //
+    pair<BinarySearchTree, BinarySearchTree> split_at(size_t rank) noexcept {
+        return splitBy([&rank](Node* r) {
+            size_t s = sizeOf(r->left);
+            if(s < rank) {
+                rank -= s + 1;
+                return -1;
+            }
+            return 1;
+        });
+    }
+
+    //
+    // @brief Réunit deux arbres dont toutes les clés de left précèdent
+    //        celles de right
+    //
+    // @return l'arbre réunissant les noeuds de left et right, qui sont vidés
+    //
+    // @exception std::logic_error si les clés se recouvrent ou si les
+    //            allocateurs diffèrent. left et right sont alors intacts.
+    //
+    //  Complexité: O(hauteur)
+    //
+    static BinarySearchTree join(BinarySearchTree&& left, BinarySearchTree&& right) {
+        if(left._root == nullptr)
+            return std::move(right);
+        if(right._root == nullptr)
+            return std::move(left);
+        if(!(left._alloc == right._alloc))
+            throw logic_error("join: allocateurs différents");
+        if(!left._comp(rightmost(left._root)->key, leftmost(right._root)->key))
+            throw logic_error("join: les clés se recouvrent");
+
+        BinarySearchTree result(left._comp, left._alloc);
+        Path path;
+        result._root = join2(left._root, right._root, path);
+        result._root->parent = nullptr;
+        left._root = right._root = nullptr;
+        Stats::record(TreeOperation::join, path);
+        return result;
+    }
+
+private:
+    template < typename Side >
+    pair<BinarySearchTree, BinarySearchTree> splitBy(Side side) noexcept {
+        pair<BinarySearchTree, BinarySearchTree> parts{ BinarySearchTree(_comp, _alloc), BinarySearchTree(_comp, _alloc) };
+        Node* lo;
+        Node* hi;
+        Path path;
+        splitNodes(_root, side, lo, hi, path);
+        Stats::record(TreeOperation::split, path);
+        _root = nullptr;
+        if(lo != nullptr)
+            lo->parent = nullptr;
+        if(hi != nullptr)
+            hi->parent = nullptr;
+        parts.first._root = lo;
+        parts.second._root = hi;
+        return parts;
+    }
+
+    //
+    // @brief Sépare un sous arbre en deux
+    //
+    // @param r la racine du sous arbre
+    // @param side appelé une fois par noeud du chemin, par ordre de
+    //        profondeur, avant toute modification du noeud. Négatif si le
+    //        noeud et son sous arbre gauche vont dans lo, positif si le
+    //        noeud et son sous arbre droit vont dans hi, nul pour détacher
+    //        le noeud: son sous arbre gauche va dans lo, le droit dans hi.
+    // @param lo, hi OUT - les racines des deux parties
+    // @param path compte les noeuds du chemin et ceux que join3 rééquilibre
+    //
+    // @return le noeud détaché, nullptr si side n'a jamais renvoyé 0
+    //
+    // Sans politique d'équilibrage, les noeuds du chemin sont accrochés
+    // de haut en bas puis nbElements est mis à jour en remontant par les
+    // liens parent. Sinon chaque niveau est recollé par join3.
+    //
+    //  Complexité: O(hauteur)
+    //
+    template < typename Side >
+    static Node* splitNodes(Node* r, Side& side, Node*& lo, Node*& hi, Path& path) noexcept {
+        if constexpr (iterativeUpdates)
+            return splitIterative(r, side, lo, hi, path);
+        else
+            return splitRecursive(r, side, lo, hi, path);
+    }
+
+    template < typename Side >
+    static Node* splitIterative(Node* r, Side& side, Node*& lo, Node*& hi, Path& path) noexcept {
+        Node** loSlot = &lo;
+        Node** hiSlot = &hi;
+        Node* loLast = nullptr;
+        Node* hiLast = nullptr;
+        Node* found = nullptr;
+        while(r != nullptr) {
+            path.visit();
+            int s = side(r);
+            if(s == 0) {
+                found = r;
+                break;
+            }
+            Node* next;
+            if(s < 0) {
+                next = r->right;
+                *loSlot = r;
+                r->parent = loLast;
+                loLast = r;
+                loSlot = &r->right;
+            } else {
+                next = r->left;
+                *hiSlot = r;
+                r->parent = hiLast;
+                hiLast = r;
+                hiSlot = &r->left;
+            }
+            r = next;
+        }
+        *loSlot = found != nullptr ? found->left : nullptr;
+        *hiSlot = found != nullptr ? found->right : nullptr;
+        for(; loLast != nullptr; loLast = loLast->parent)
+            update(loLast);
+        for(; hiLast != nullptr; hiLast = hiLast->parent)
+            update(hiLast);
+        if(found != nullptr)
+            detach(found);
+        return found;
+    }
+
+    template < typename Side >
+    static Node* splitRecursive(Node* r, Side& side, Node*& lo, Node*& hi, Path& path) noexcept {
+        if(r == nullptr) {
+            lo = hi = nullptr;
+            return nullptr;
+        }
+        path.visit();
+        int s = side(r);
+        Node* l = r->left;
+        Node* rr = r->right;
+        if(s == 0) {
+            lo = l;
+            hi = rr;
+            detach(r);
+            return r;
+        }
+        r->left = r->right = nullptr;
+        Node* middle;
+        Node* found;
+        if(s < 0) {
+            found = splitRecursive(rr, side, middle, hi, path);
+            lo = join3(l, r, middle, path);
+        } else {
+            found = splitRecursive(l, side, lo, middle, path);
+            hi = join3(middle, r, rr, path);
+        }
+        return found;
+    }
+
+    static void detach(Node* r) noexcept {
+        r->left = r->right = r->parent = nullptr;
+        update(r);
+    }
+
+    //
+    // @brief Réunit deux sous arbres et un noeud intermédiaire
+    //
+    // @param l, r les sous arbres. Les clés de l précèdent k, celles de r
+    //             le suivent
+    // @param k le noeud détaché servant de jonction
+    // @param path compte les noeuds du bord parcouru et ceux que les
+    //        rotations déplacent ou que rebuild reconstruit
+    //
+    // @return la racine du sous arbre réuni. Son lien parent n'est pas mis
+    //         à jour.
+    //
+    // Avec AVL, k est accroché le long du bord de l'arbre le plus haut, a
+    // la hauteur de l'autre, puis les niveaux traversés sont rééquilibrés.
+    // Avec une politique pondérée, k est accroché le long du bord de
+    // l'arbre le plus lourd, au premier sous arbre dont le poids s'accorde
+    // avec celui de l'autre, puis les niveaux traversés sont rééquilibrés
+    // par rotations (rotateToWeights).
+    //
+    //  Complexité: O(1) sans équilibrage, O(|hauteur(l) - hauteur(r)|) avec
+    //  AVL ou scapegoat
+    //
+    static Node* join3(Node* l, Node* k, Node* r, Path& path) noexcept {
+        path.visit();
+        if constexpr (is_same<Balancing, AVLBalancing>::value) {
+            if(heightOf(l) > heightOf(r) + 1) {
+                l->right = join3(l->right, k, r, path);
+                rebalance(l);
+                return l;
+            }
+            if(heightOf(r) > heightOf(l) + 1) {
+                r->left = join3(l, k, r->left, path);
+                rebalance(r);
+                return r;
+            }
+        } else if constexpr (isWeightBalanced<Balancing>::value) {
+            size_t n = sizeOf(l) + sizeOf(r) + 1;
+            if(Balancing::tooHeavy(sizeOf(l), n)) {
+                l->right = join3(l->right, k, r, path);
+                rotateToWeights(l, path);
+                return l;
+            }
+            if(Balancing::tooHeavy(sizeOf(r), n)) {
+                r->left = join3(l, k, r->left, path);
+                rotateToWeights(r, path);
+                return r;
+            }
+        }
+        k->left = l;
+        k->right = r;
+        rebalance(k);
+        return k;
+    }
+
+    //
+    // @brief Rééquilibre par rotations un noeud dont un sous arbre vient
+    //        d'etre agrandi par join3, avec une politique pondérée
+    //
+    // Rotation simple ou double selon les poids, comme pour les arbres
+    // pondérés (Blelloch et al., "Just join for parallel ordered sets").
+    // Avec un seuil inférieur à 1/sqrt(2), comme 2/3, une rotation
+    // peut laisser un enfant trop lourd: il est rééquilibré de meme. Le
+    // sous arbre n'est reconstruit qu'en dernier recours.
+    //
+    //  Complexité: O(1) le plus souvent, O(hauteur) au pire sans
+    //  reconstruction
+    //
+    static void rotateToWeights(Node*& r, Path& path) noexcept {
+        path.visit();
+        update(r);
+        if(Balancing::tooHeavy(sizeOf(r->right), r->nbElements)) {
+            Node* c = r->right;
+            if(weightsMatch(sizeOf(r->left), sizeOf(c->left))
+               && weightsMatch(sizeOf(r->left) + sizeOf(c->left) + 1, sizeOf(c->right)))
+                rotateLeft(r);
+            else if(c->left != nullptr) {
+                rotateRight(r->right);
+                rotateLeft(r);
+            }
+        } else if(Balancing::tooHeavy(sizeOf(r->left), r->nbElements)) {
+            Node* c = r->left;
+            if(weightsMatch(sizeOf(r->right), sizeOf(c->right))
+               && weightsMatch(sizeOf(r->right) + sizeOf(c->right) + 1, sizeOf(c->left)))
+                rotateRight(r);
+            else if(c->right != nullptr) {
+                rotateLeft(r->left);
+                rotateRight(r);
+            }
+        } else
+            return;
+        if(!weightsMatch(r->left))
+            rotateToWeights(r->left, path);
+        if(!weightsMatch(r->right))
+            rotateToWeights(r->right, path);
+        update(r);
+        if(!weightsMatch(r)) {
+            path.visit(r->nbElements);
+            rebuild(r);
+        }
+    }
+
+    // vrai si deux sous arbres de tailles a et b peuvent etre les enfants
+    // d'un meme noeud
+    static bool weightsMatch(size_t a, size_t b) noexcept {
+        size_t n = a + b + 1;
+        return !Balancing::tooHeavy(a, n) && !Balancing::tooHeavy(b, n);
+    }
+
+    static bool weightsMatch(Node* r) noexcept {
+        return r == nullptr || weightsMatch(sizeOf(r->left), sizeOf(r->right));
+    }
+
+    //
+    // @brief Réunit deux sous arbres dont les clés de l précèdent celles de r
+    //
+    // Le minimum de r sert de noeud de jonction.
+    //
+    //  Complexité: O(hauteur)
+    //
+    static Node* join2(Node* l, Node* r, Path& path) noexcept {
+        if(l == nullptr)
+            return r;
+        if(r == nullptr)
+            return l;
+        Node* middle;
+        if constexpr (iterativeUpdates)
+            middle = deleteMinIterative(r, path);
+        else
+            middle = deleteMinAndReturnIt(r, path);
+        return join3(l, middle, r, path);
+    }
+
+public:
+    //
+    // @brief Union, intersection et différence de deux arbres
+    //
+    // @param a, b les arbres, dont les noeuds sont réutilisés par le
+    //        résultat. Passer une copie pour les conserver.
+    // @param pool les threads exécutant les sous problèmes indépendants
+    //
+    // @return l'arbre des clés de a ou b, de a et b, de a sans celles de b
+    //
+    // La racine de b sépare a en deux par split, puis les deux moitiés sont
+    // combinées récursivement et en parallèle avec les sous arbres de b et
+    // recollées par join3 (Blelloch et al., "Just join for parallel ordered
+    // sets"). Le parallélisme n'est utilisé que si l'allocateur est
+    // threadSafe. Si les allocateurs de a et b diffèrent, b est d'abord
+    // copié dans celui de a.
+    //
+    //  Complexité: O(m log(n/m + 1)) avec m <= n les tailles, pour des
+    //  arbres de hauteur logarithmique: AVL, scapegoat, ou sans politique
+    //  après balance(). Profondeur O(log(n)^2).
+    //
+    static BinarySearchTree set_union(BinarySearchTree a, BinarySearchTree b,
+                                      TaskPool& pool = TaskPool::global()) {
+        return combine(SetOperation::Union, a, b, pool);
+    }
+
+    static BinarySearchTree set_intersection(BinarySearchTree a, BinarySearchTree b,
+                                             TaskPool& pool = TaskPool::global()) {
+        return combine(SetOperation::Intersection, a, b, pool);
+    }
+
+    static BinarySearchTree set_difference(BinarySearchTree a, BinarySearchTree b,
+                                           TaskPool& pool = TaskPool::global()) {
+        return combine(SetOperation::Difference, a, b, pool);
+    }
+
+private:
+    enum class SetOperation { Union, Intersection, Difference };
+
+    // taille minimale d'un sous problème confié à un autre thread
+    static constexpr size_t setGrain = 4096;
+
+    // au delà de cette profondeur, un arbre trop haut (sans politique
+    // d'équilibrage) est combiné par fusion de listes, sans récursion
+    static constexpr size_t setMaxDepth = 128;
+
+    static BinarySearchTree combine(SetOperation op, BinarySearchTree& a, BinarySearchTree& b, TaskPool& pool) {
+        if(!(a._alloc == b._alloc)) {
+            BinarySearchTree copy(a._comp, a._alloc);
+            copy._root = iterative ? copy.copyNodeIterative(b._root) : copy.copyNode(b._root);
+            b.swap(copy);
+        }
+        BinarySearchTree result(a._comp, a._alloc);
+        Node* ra = a._root;
+        Node* rb = b._root;
+        a._root = b._root = nullptr;
+        result._root = result.combine(op, ra, rb, pool, 0);
+        if(result._root != nullptr)
+            result._root->parent = nullptr;
+        return result;
+    }
+
+    Node* combine(SetOperation op, Node* a, Node* b, TaskPool& pool, size_t depth) noexcept {
+        if(a == nullptr || b == nullptr) {
+            if(op == SetOperation::Union)
+                return a != nullptr ? a : b;
+            deleteSubTreeIterative(b);
+            if(op == SetOperation::Difference)
+                return a;
+            deleteSubTreeIterative(a);
+            return nullptr;
+        }
+        if(depth == setMaxDepth)
+            return combineLists(op, a, b);
+
+        bool parallel = allocator_type::threadSafe && pool.concurrency() > 1
+                        && a->nbElements + b->nbElements >= setGrain;
+        Node* k = b;
+        Node* bl = b->left;
+        Node* br = b->right;
+        const_reference key = k->key;
+        auto side = [this, &key](Node* r) { return -compareKeys(key, r->key); };
+        Node* al;
+        Node* ar;
+        // les noeuds parcourus ne sont pas comptés par Stats
+        Path path;
+        Node* found = splitNodes(a, side, al, ar, path);
+        detach(k);
+
+        Node* l;
+        Node* r;
+        auto left = [&] { l = combine(op, al, bl, pool, depth + 1); };
+        auto right = [&] { r = combine(op, ar, br, pool, depth + 1); };
+        if(parallel)
+            pool.invoke(left, right);
+        else {
+            left();
+            right();
+        }
+
+        if(found != nullptr)
+            destroyNode(found);
+        if(op == SetOperation::Union || (op == SetOperation::Intersection && found != nullptr))
+            return join3(l, k, r, path);
+        destroyNode(k);
+        return join2(l, r, path);
+    }
+
+    //
+    // @brief Combine deux sous arbres par fusion de leurs listes
+    //
+    //  Complexité: O(n + m), sans récursion si ABR_RECURSIVE n'est pas défini
+    //
+    Node* combineLists(SetOperation op, Node* a, Node* b) noexcept {
+        Node* la = nullptr;
+        Node* lb = nullptr;
+        size_t cnt = 0;
+        if constexpr (iterative) {
+            linearizeIterative(a, la, cnt);
+            linearizeIterative(b, lb, cnt);
+        } else {
+            linearize(a, la, cnt);
+            linearize(b, lb, cnt);
+        }
+
+        Node* merged = nullptr;
+        Node** tail = &merged;
+        size_t total = 0;
+        while(la != nullptr || lb != nullptr) {
+            Node* next;
+            bool keep;
+            if(lb == nullptr || (la != nullptr && _comp(la->key, lb->key))) {
+                next = la;
+                la = la->right;
+                keep = op != SetOperation::Intersection;
+            } else if(la == nullptr || _comp(lb->key, la->key)) {
+                next = lb;
+                lb = lb->right;
+                keep = op == SetOperation::Union;
+            } else {
+                next = la;
+                la = la->right;
+                Node* duplicate = lb;
+                lb = lb->right;
+                destroyNode(duplicate);
+                keep = op != SetOperation::Difference;
+            }
+            if(keep) {
+                *tail = next;
+                tail = &next->right;
+                ++total;
+            } else
+                destroyNode(next);
+        }
+        *tail = nullptr;
 
+        Node* root;
+        if constexpr (iterative)
+            arborizeIterative(root, merged, total);
+        else
+            arborize(root, merged, total);
+        return root;
     }
 
 public:
@@ -706,7 +3143,7 @@ public:
     //  Complexité: O(n)
     //
     template < typename Fn>
-    void visitPre(Node* r, Fn f){
+    void visitPre(Node* r, Fn f) const {
         if(r != nullptr){
             f(r->key);
             visitPre(r->left, f);
@@ -715,7 +3152,7 @@ public:
     }
 
     template < typename Fn >
-    void visitPre (Fn f) {
+    void visitPre (Fn f) const {
         visitPre(_root, f);
     }
 
@@ -729,7 +3166,7 @@ public:
     //  Complexité: O(n)	
     //
     template < typename Fn>
-    void visitsym(Node* r, Fn f){
+    void visitsym(Node* r, Fn f) const {
         if(r != nullptr){
             visitsym(r->left, f);
             f(r->key);
@@ -738,7 +3175,7 @@ public:
     }
 
     template < typename Fn >
-    void visitSym (Fn f) {
+    void visitSym (Fn f) const {
         visitsym(_root, f);
     }
 
@@ -752,7 +3189,7 @@ public:
     // Complexité: O(n)
     //
     template < typename Fn>
-    void visitPost(Node* r, Fn f){
+    void visitPost(Node* r, Fn f) const {
         if(r != nullptr){
             visitPost(r->left, f);
             visitPost(r->right, f);
@@ -760,7 +3197,7 @@ public:
         }
     }
     template < typename Fn >
-    void visitPost (Fn f) {
+    void visitPost (Fn f) const {
         visitPost(_root, f);
     }
 
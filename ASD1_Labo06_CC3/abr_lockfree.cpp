@@ -0,0 +1,486 @@
+//
+//  Binary Search Tree sans verrou
+//
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+//
+// @brief Récupération de la mémoire par époques (epoch based reclamation)
+//
+// Un noeud retiré de la structure peut encore etre lu par les threads qui
+// le parcouraient. Chaque opération annonce l'époque globale courante
+// pendant son exécution (pin). Un noeud retiré pendant l'époque e n'est
+// libéré qu'une fois l'époque globale arrivée à e + 2: tous les threads
+// qui pouvaient le voir ont alors terminé leur opération.
+//
+// Node doit avoir un champ Node* retiredNext, utilisé pour chainer les
+// noeuds retirés sans allocation. Chaque thread reçoit à sa première
+// opération un enregistrement, conservé jusqu'à la destruction du domaine.
+// Le thread oublie les domaines détruits à son prochain enregistrement.
+//
+template < typename Node >
+class EpochDomain {
+    struct Record {
+        atomic<uint64_t> local{ 0 }; // 0 hors opération, sinon 2 * époque + 1
+        Node* bags[3] = {};          // noeuds retirés, par époque modulo 3
+        uint64_t bagEpoch[3] = {};
+        size_t retired = 0;
+        Record* next = nullptr;
+    };
+
+    // nombre de retraits entre deux tentatives d'avancer l'époque
+    static constexpr size_t advanceEvery = 64;
+
+    atomic<uint64_t> epoch{ 0 };
+    atomic<Record*> records{ nullptr };
+
+    // faux dès la destruction du domaine. Partagé avec les threads qui y
+    // sont enregistrés, il identifie aussi le domaine dans owned.
+    const shared_ptr<atomic<bool>> alive = make_shared<atomic<bool>>(true);
+
+    // enregistrements du thread, par domaine
+    static inline thread_local vector<pair<shared_ptr<const atomic<bool>>, Record*>> owned;
+
+public:
+    //
+    // @brief Opération en cours. Les noeuds lus restent valides tant
+    //        qu'elle existe.
+    //
+    class Guard {
+        friend class EpochDomain;
+        Record* record;
+
+        explicit Guard(Record* record) noexcept : record(record) {
+        }
+
+    public:
+        Guard(const Guard&) = delete;
+        Guard& operator = (const Guard&) = delete;
+
+        ~Guard() {
+            record->local.store(0, memory_order_release);
+        }
+    };
+
+    EpochDomain() = default;
+
+    EpochDomain(const EpochDomain&) = delete;
+    EpochDomain& operator = (const EpochDomain&) = delete;
+
+    //
+    // Libère tous les noeuds retirés. Aucune opération ne doit etre en
+    // cours.
+    //
+    ~EpochDomain() {
+        alive->store(false, memory_order_relaxed);
+        Record* r = records.load();
+        while(r != nullptr) {
+            for(Node* bag : r->bags)
+                release(bag);
+            Record* next = r->next;
+            delete r;
+            r = next;
+        }
+    }
+
+    //
+    // @brief Commence une opération
+    //
+    // @exception std::bad_alloc à la première opération d'un thread, si
+    //            son enregistrement ne peut pas etre créé
+    //
+    Guard pin() {
+        Record* r = record();
+        r->local.store(2 * epoch.load() + 1);
+        atomic_thread_fence(memory_order_seq_cst);
+        return Guard(r);
+    }
+
+    //
+    // @brief Confie un noeud détaché de la structure, libéré dès qu'aucune
+    //        opération ne peut plus le lire
+    //
+    void retire(Guard& guard, Node* n) noexcept {
+        Record* r = guard.record;
+        uint64_t e = epoch.load();
+        for(size_t i = 0; i < 3; ++i)
+            if(r->bags[i] != nullptr && r->bagEpoch[i] + 2 <= e) {
+                release(r->bags[i]);
+                r->bags[i] = nullptr;
+            }
+        size_t i = e % 3;
+        n->retiredNext = r->bags[i];
+        r->bags[i] = n;
+        r->bagEpoch[i] = e;
+        if(++r->retired % advanceEvery == 0)
+            tryAdvance();
+    }
+
+private:
+    void tryAdvance() noexcept {
+        uint64_t e = epoch.load();
+        for(Record* r = records.load(); r != nullptr; r = r->next) {
+            uint64_t local = r->local.load();
+            if(local != 0 && local != 2 * e + 1)
+                return;
+        }
+        epoch.compare_exchange_strong(e, e + 1);
+    }
+
+    static void release(Node* n) noexcept {
+        while(n != nullptr) {
+            Node* next = n->retiredNext;
+            delete n;
+            n = next;
+        }
+    }
+
+    Record* record() {
+        for(auto& o : owned)
+            if(o.first == alive)
+                return o.second;
+        // les domaines détruits depuis le dernier enregistrement sont
+        // oubliés: owned ne grandit pas avec le nombre de domaines
+        // créés puis détruits
+        owned.erase(remove_if(owned.begin(), owned.end(),
+                              [](const auto& o) { return !o.first->load(memory_order_relaxed); }),
+                    owned.end());
+        owned.reserve(owned.size() + 1);
+        Record* r = new Record;
+        r->next = records.load();
+        while(!records.compare_exchange_weak(r->next, r))
+            ;
+        owned.emplace_back(alive, r);
+        return r;
+    }
+};
+
+//
+// @brief Arbre binaire de recherche concurrent sans verrou
+//
+// Arbre externe de Natarajan et Mittal ("Fast concurrent lock-free binary
+// search trees", PPoPP 2014): les clés sont dans les feuilles, les noeuds
+// internes ne servent qu'à l'aiguillage. Une suppression marque d'abord
+// l'arete vers la feuille (flag), puis l'arete vers sa soeur (tag), ce qui
+// les fige, avant de raccrocher la soeur plus haut par un seul
+// compare_exchange. Un thread qui rencontre une suppression en cours
+// l'achève avant de continuer.
+//
+// Trois sentinelles ∞0 < ∞1 < ∞2, plus grandes que toute clé, évitent les
+// cas particuliers près de la racine. La mémoire des noeuds retirés est
+// récupérée par EpochDomain.
+//
+// insert, contains et deleteElement peuvent etre appelés par plusieurs
+// threads à la fois.
+//
+template < typename T >
+class LockFreeBinarySearchTree {
+public:
+    using value_type = T;
+    using const_reference = const T&;
+
+private:
+    struct Sentinel {
+        int infinity;
+    };
+
+    struct Node {
+        atomic<uintptr_t> left{ 0 };  // enfants, avec les bits flag et tag
+        atomic<uintptr_t> right{ 0 };
+        Node* retiredNext = nullptr;  // chainage dans EpochDomain
+        const int infinity;           // 0 pour une clé, 1 à 3 pour ∞0 à ∞2
+        union {
+            const value_type key;
+        };
+
+        explicit Node(const_reference key) : infinity(0), key(key) {
+        }
+
+        explicit Node(Sentinel s) noexcept : infinity(s.infinity) {
+        }
+
+        ~Node() {
+            if(infinity == 0)
+                key.~value_type();
+        }
+    };
+
+    static constexpr uintptr_t flagBit = 1; // la feuille pointée est supprimée
+    static constexpr uintptr_t tagBit = 2;  // l'arete ne peut plus changer
+    static constexpr uintptr_t markBits = flagBit | tagBit;
+
+    //
+    // @brief Résultat de seek
+    //
+    // leaf est la feuille atteinte, parent son parent. successor est le
+    // plus haut noeud du chemin dont l'arete d'accès n'est pas marquée,
+    // ancestor le parent de successor.
+    //
+    struct SeekRecord {
+        Node* ancestor;
+        Node* successor;
+        Node* parent;
+        Node* leaf;
+    };
+
+    Node* _root;                           // sentinelle ∞2
+    mutable EpochDomain<Node> _domain;
+    using Guard = typename EpochDomain<Node>::Guard;
+
+    static Node* address(uintptr_t field) noexcept {
+        return reinterpret_cast<Node*>(field & ~markBits);
+    }
+
+    static uintptr_t field(Node* n, uintptr_t bits = 0) noexcept {
+        return reinterpret_cast<uintptr_t>(n) | bits;
+    }
+
+    static bool isLeaf(Node* n) noexcept {
+        return n->left.load(memory_order_acquire) == 0;
+    }
+
+    static bool less(const_reference key, Node* n) noexcept {
+        return n->infinity != 0 || key < n->key;
+    }
+
+    static bool equal(const_reference key, Node* n) noexcept {
+        return n->infinity == 0 && !(key < n->key) && !(n->key < key);
+    }
+
+    static atomic<uintptr_t>& childOf(Node* n, const_reference key) noexcept {
+        return less(key, n) ? n->left : n->right;
+    }
+
+public:
+    //
+    // @brief Construit un arbre vide, formé des seules sentinelles
+    //
+    LockFreeBinarySearchTree() {
+        unique_ptr<Node> r(new Node(Sentinel{ 3 }));
+        unique_ptr<Node> s(new Node(Sentinel{ 2 }));
+        unique_ptr<Node> inf0(new Node(Sentinel{ 1 }));
+        unique_ptr<Node> inf1(new Node(Sentinel{ 2 }));
+        unique_ptr<Node> inf2(new Node(Sentinel{ 3 }));
+        s->left.store(field(inf0.release()));
+        s->right.store(field(inf1.release()));
+        r->left.store(field(s.release()));
+        r->right.store(field(inf2.release()));
+        _root = r.release();
+    }
+
+    LockFreeBinarySearchTree(const LockFreeBinarySearchTree&) = delete;
+    LockFreeBinarySearchTree& operator = (const LockFreeBinarySearchTree&) = delete;
+
+    //
+    // Aucune opération ne doit etre en cours.
+    //
+    ~LockFreeBinarySearchTree() {
+        vector<Node*> todo{ _root };
+        while(!todo.empty()) {
+            Node* n = todo.back();
+            todo.pop_back();
+            if(Node* l = address(n->left.load()))
+                todo.push_back(l);
+            if(Node* r = address(n->right.load()))
+                todo.push_back(r);
+            delete n;
+        }
+    }
+
+    //
+    // @brief Insertion d'une cle dans l'arbre
+    //
+    // @return vrai si la clé a été insérée, faux si elle était présente
+    //
+    //  Complexité: O(hauteur) sans contention
+    //
+    bool insert(const_reference key) {
+        Guard guard = _domain.pin();
+        unique_ptr<Node> newLeaf(new Node(key));
+        SeekRecord s;
+        for(;;) {
+            seek(key, s);
+            Node* leaf = s.leaf;
+            if(equal(key, leaf))
+                return false;
+
+            unique_ptr<Node> internal;
+            if(less(key, leaf)) {
+                internal.reset(leaf->infinity != 0 ? new Node(Sentinel{ leaf->infinity }) : new Node(leaf->key));
+                internal->left.store(field(newLeaf.get()), memory_order_relaxed);
+                internal->right.store(field(leaf), memory_order_relaxed);
+            } else {
+                internal.reset(new Node(key));
+                internal->left.store(field(leaf), memory_order_relaxed);
+                internal->right.store(field(newLeaf.get()), memory_order_relaxed);
+            }
+
+            uintptr_t expected = field(leaf);
+            if(childOf(s.parent, key).compare_exchange_strong(expected, field(internal.get()))) {
+                internal.release();
+                newLeaf.release();
+                return true;
+            }
+            if(address(expected) == leaf && (expected & markBits) != 0)
+                cleanup(guard, key, s);
+        }
+    }
+
+    //
+    // @brief Recherche d'une cle.
+    //
+    //  Complexité: O(hauteur), sans écriture dans l'arbre
+    //
+    bool contains(const_reference key) const {
+        Guard guard = _domain.pin();
+        SeekRecord s;
+        seek(key, s);
+        return equal(key, s.leaf);
+    }
+
+    //
+    // @brief Supprime l'element de cle key de l'arbre.
+    //
+    // @return vrai si cet appel a supprimé la clé
+    //
+    // La clé est supprimée dès que l'arete vers sa feuille est marquée.
+    // L'appel se poursuit jusqu'à ce que la feuille soit détachée, par lui
+    // ou par un autre thread.
+    //
+    //  Complexité: O(hauteur) sans contention
+    //
+    bool deleteElement(const_reference key) {
+        Guard guard = _domain.pin();
+        SeekRecord s;
+        Node* leaf = nullptr;
+        for(;;) {
+            seek(key, s);
+            if(leaf == nullptr) {
+                if(!equal(key, s.leaf))
+                    return false;
+                uintptr_t expected = field(s.leaf);
+                if(childOf(s.parent, key).compare_exchange_strong(expected, field(s.leaf, flagBit))) {
+                    leaf = s.leaf;
+                    if(cleanup(guard, key, s))
+                        return true;
+                } else if(address(expected) == s.leaf && (expected & markBits) != 0)
+                    cleanup(guard, key, s);
+            } else {
+                if(s.leaf != leaf || cleanup(guard, key, s))
+                    return true;
+            }
+        }
+    }
+
+    //
+    // @brief Recherche de la cle minimale.
+    //
+    // @return une copie de la clé: sa feuille peut etre libérée dès la fin
+    //         de l'appel
+    //
+    // Sans mise à jour concurrente, la plus petite clé. Sinon une clé
+    // présente pendant l'appel.
+    //
+    // @exception std::logic_error si l'arbre est vide
+    //
+    value_type min() const {
+        Guard guard = _domain.pin();
+        for(;;) {
+            Node* parent = address(_root->left.load(memory_order_acquire));
+            uintptr_t leafField = parent->left.load(memory_order_acquire);
+            Node* leaf = address(leafField);
+            while(!isLeaf(leaf)) {
+                leafField = leaf->left.load(memory_order_acquire);
+                leaf = address(leafField);
+            }
+            if(leaf->infinity != 0)
+                throw logic_error("empty tree");
+            if((leafField & flagBit) == 0)
+                return leaf->key;
+
+            // la feuille est en cours de suppression: l'achever et recommencer
+            SeekRecord s;
+            seek(leaf->key, s);
+            if(s.leaf == leaf)
+                cleanup(guard, leaf->key, s);
+        }
+    }
+
+private:
+    //
+    // @brief Descend jusqu'à la feuille de key
+    //
+    void seek(const_reference key, SeekRecord& s) const noexcept {
+        Node* sentinel = address(_root->left.load(memory_order_acquire));
+        s.ancestor = _root;
+        s.successor = sentinel;
+        s.parent = sentinel;
+        uintptr_t parentField = sentinel->left.load(memory_order_acquire);
+        s.leaf = address(parentField);
+        uintptr_t currentField = s.leaf->left.load(memory_order_acquire);
+        for(Node* current = address(currentField); current != nullptr; current = address(currentField)) {
+            if((parentField & tagBit) == 0) {
+                s.ancestor = s.parent;
+                s.successor = s.leaf;
+            }
+            s.parent = s.leaf;
+            s.leaf = current;
+            parentField = currentField;
+            currentField = childOf(current, key).load(memory_order_acquire);
+        }
+    }
+
+    //
+    // @brief Détache la feuille marquée sous s.parent et les noeuds figés
+    //        entre s.successor et s.parent
+    //
+    // @return vrai si cet appel a effectué le détachement
+    //
+    bool cleanup(Guard& guard, const_reference key, const SeekRecord& s) const noexcept {
+        atomic<uintptr_t>& successorEdge = childOf(s.ancestor, key);
+        atomic<uintptr_t>* childEdge = &s.parent->left;
+        atomic<uintptr_t>* siblingEdge = &s.parent->right;
+        if(!less(key, s.parent))
+            std::swap(childEdge, siblingEdge);
+        if((childEdge->load() & flagBit) == 0)
+            siblingEdge = childEdge; // la feuille supprimée est de l'autre coté
+
+        uintptr_t sibling = siblingEdge->fetch_or(tagBit) & ~tagBit;
+        uintptr_t expected = field(s.successor);
+        if(!successorEdge.compare_exchange_strong(expected, sibling))
+            return false;
+        retireDetached(guard, s.successor, address(sibling));
+        return true;
+    }
+
+    //
+    // @brief Retire les noeuds détachés par cleanup
+    //
+    // Ils forment un chemin de noeuds internes de successor à parent. Les
+    // aretes de ce chemin sont figées, et chaque noeud a une feuille marquée
+    // comme autre enfant. kept est le sous arbre raccroché.
+    //
+    void retireDetached(Guard& guard, Node* n, Node* kept) const noexcept {
+        while(n != nullptr) {
+            Node* next = nullptr;
+            for(Node* child : { address(n->left.load()), address(n->right.load()) }) {
+                if(child == kept)
+                    continue;
+                if(isLeaf(child))
+                    _domain.retire(guard, child);
+                else
+                    next = child;
+            }
+            _domain.retire(guard, n);
+            n = next;
+        }
+    }
+};
@@ -0,0 +1,360 @@
+//
+//  Binary Search Tree persistant
+//
+
+#include <atomic>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+//
+// @brief Arbre binaire de recherche persistant (copy-on-write)
+//
+// Les copies partagent leurs noeuds: copier un arbre coute O(1) et fournit
+// un instantané stable. insert, deleteElement et deleteMin ne modifient
+// jamais un noeud existant mais recopient le chemin de la racine au noeud
+// touché (path copying): O(hauteur) noeuds neufs, le reste est partagé.
+//
+// Les noeuds sont immuables et comptent leurs références de façon
+// atomique. Des threads différents peuvent donc lire et modifier des
+// copies différentes. Un meme objet ne doit pas etre modifié pendant qu'un
+// autre thread le lit ou le copie.
+//
+// Les noeuds n'ont pas de lien parent, qui ne peut pas etre partagé, et
+// l'arbre n'est pas rééquilibré.
+//
+template < typename T >
+class PersistentBinarySearchTree {
+public:
+    using value_type = T;
+    using reference = T&;
+    using const_reference = const T&;
+
+private:
+    struct Node {
+        const value_type key;
+        Node* right = nullptr;
+        Node* left = nullptr;
+        size_t nbElements;
+        atomic<size_t> refs{ 1 }; // nombre de parents et d'arbres pointant ce noeud
+
+        Node(const_reference key, size_t nbElements) : key(key), nbElements(nbElements) {
+        }
+    };
+
+    Node* _root = nullptr;
+
+    static Node* acquire(Node* r) noexcept {
+        if(r != nullptr)
+            r->refs.fetch_add(1, memory_order_relaxed);
+        return r;
+    }
+
+    //
+    // @brief Rend une référence sur r et détruit les noeuds qui ne sont
+    //        plus référencés
+    //
+    // Un noeud mort dont l'enfant gauche meurt aussi subit une rotation
+    // droite: la liste des noeuds morts reste chainée par les liens droits,
+    // sans pile ni récursion.
+    //
+    //  Complexité: O(nombre de noeuds détruits), mémoire supplémentaire O(1)
+    //
+    static void release(Node* r) noexcept {
+        if(r == nullptr || r->refs.fetch_sub(1, memory_order_acq_rel) != 1)
+            return;
+        while(r != nullptr) {
+            Node* l = r->left;
+            if(l == nullptr) {
+                Node* next = r->right;
+                delete r;
+                r = next != nullptr && next->refs.fetch_sub(1, memory_order_acq_rel) == 1 ? next : nullptr;
+            } else if(l->refs.fetch_sub(1, memory_order_acq_rel) == 1) {
+                r->left = l->right;
+                r->refs.store(1, memory_order_relaxed); // référencé par l
+                l->right = r;
+                r = l;
+            } else
+                r->left = nullptr;
+        }
+    }
+
+    //
+    // @brief Crée la copie de r sur le chemin modifié
+    //
+    // Les deux enfants sont partagés; celui par lequel le chemin continue
+    // sera remplacé par l'appelant.
+    //
+    static Node* copyOnPath(Node* r, size_t nbElements, bool goesLeft) {
+        Node* c = new Node(r->key, nbElements);
+        if(goesLeft)
+            c->right = acquire(r->right);
+        else
+            c->left = acquire(r->left);
+        return c;
+    }
+
+    //
+    // @brief Remplace la racine par celle d'un chemin recopié
+    //
+    // En cas d'exception pendant la recopie, le chemin partiel est rendu
+    // et l'arbre est inchangé.
+    //
+    template < typename Fn >
+    void rewrite(Fn copyPath) {
+        Node* root = nullptr;
+        try {
+            copyPath(root);
+        } catch(...) {
+            release(root);
+            throw;
+        }
+        release(_root);
+        _root = root;
+    }
+
+public:
+    /**
+     *  @brief Constructeur par défaut. Construit un arbre vide
+     */
+    PersistentBinarySearchTree() = default;
+
+    /**
+     *  @brief Constucteur de copie. Les noeuds sont partagés.
+     *
+     *  Complexité: O(1)
+     */
+    PersistentBinarySearchTree(const PersistentBinarySearchTree& other) noexcept
+            : _root(acquire(other._root)) {
+    }
+
+    PersistentBinarySearchTree(PersistentBinarySearchTree&& other) noexcept
+            : _root(std::exchange(other._root, nullptr)) {
+    }
+
+    /**
+     *  @brief Affectation par copie ou déplacement
+     *
+     *  Complexité: O(1) plus la destruction des noeuds qui ne sont plus
+     *  partagés
+     */
+    PersistentBinarySearchTree& operator = (PersistentBinarySearchTree other) noexcept {
+        swap(other);
+        return *this;
+    }
+
+    void swap(PersistentBinarySearchTree& other) noexcept {
+        std::swap(_root, other._root);
+    }
+
+    ~PersistentBinarySearchTree() {
+        release(_root);
+    }
+
+    //
+    // @brief taille de l'arbre
+    //
+    //  Complexité: O(1)
+    //
+    size_t size() const noexcept {
+        return _root != nullptr ? _root->nbElements : 0;
+    }
+
+    //
+    // @brief Recherche d'une cle.
+    //
+    //  Complexité: O(hauteur)
+    //
+    bool contains(const_reference key) const noexcept {
+        for(Node* r = _root; r != nullptr; ) {
+            if(key < r->key)
+                r = r->left;
+            else if(r->key < key)
+                r = r->right;
+            else
+                return true;
+        }
+        return false;
+    }
+
+    //
+    // @brief Insertion d'une cle dans l'arbre
+    //
+    // Le chemin de la racine au nouveau noeud est recopié. Si la clé est
+    // déjà présente, l'arbre n'est pas modifié. Garantie forte en cas
+    // d'exception.
+    //
+    //  Complexité: O(hauteur) en temps et en mémoire
+    //
+    void insert(const_reference key) {
+        if(contains(key))
+            return;
+        rewrite([&](Node*& root) {
+            Node** slot = &root;
+            for(Node* r = _root; r != nullptr; ) {
+                bool left = key < r->key;
+                Node* c = copyOnPath(r, r->nbElements + 1, left);
+                *slot = c;
+                slot = left ? &c->left : &c->right;
+                r = left ? r->left : r->right;
+            }
+            *slot = new Node(key, 1);
+        });
+    }
+
+    //
+    // @brief Supprime l'element de cle key de l'arbre.
+    //
+    // @return vrai si la clé était présente
+    //
+    // Un noeud à deux enfants est remplacé par une copie de son successeur.
+    // Garantie forte en cas d'exception.
+    //
+    //  Complexité: O(hauteur) en temps et en mémoire
+    //
+    bool deleteElement(const_reference key) {
+        if(!contains(key))
+            return false;
+        rewrite([&](Node*& root) {
+            Node** slot = &root;
+            Node* r = _root;
+            while(key < r->key || r->key < key) {
+                bool left = key < r->key;
+                Node* c = copyOnPath(r, r->nbElements - 1, left);
+                *slot = c;
+                slot = left ? &c->left : &c->right;
+                r = left ? r->left : r->right;
+            }
+            if(r->left == nullptr)
+                *slot = acquire(r->right);
+            else if(r->right == nullptr)
+                *slot = acquire(r->left);
+            else {
+                Node* m = r->right;
+                while(m->left != nullptr)
+                    m = m->left;
+                Node* c = new Node(m->key, r->nbElements - 1);
+                *slot = c;
+                c->left = acquire(r->left);
+                removeMin(r->right, c->right);
+            }
+        });
+        return true;
+    }
+
+    //
+    // @brief Supprime le plus petit element de l'arbre.
+    //
+    // @exception std::logic_error si l'arbre est vide
+    //
+    //  Complexité: O(hauteur) en temps et en mémoire
+    //
+    void deleteMin() {
+        if(_root == nullptr)
+            throw logic_error("empty tree");
+        rewrite([&](Node*& root) { removeMin(_root, root); });
+    }
+
+    //
+    // @brief Recherche de la cle minimale.
+    //
+    // @exception std::logic_error si l'arbre est vide
+    //
+    const_reference min() const {
+        if(_root == nullptr)
+            throw logic_error("empty tree");
+        Node* r = _root;
+        while(r->left != nullptr)
+            r = r->left;
+        return r->key;
+    }
+
+    //
+    // @brief cle en position n par ordre croissant
+    //
+    // @exception std::logic_error si n >= size()
+    //
+    //  Complexité: O(hauteur)
+    //
+    const_reference nth_element(size_t n) const {
+        if(n >= size())
+            throw logic_error("Erreur: La position est en dehors du tableau.");
+        Node* r = _root;
+        for(;;) {
+            size_t s = r->left != nullptr ? r->left->nbElements : 0;
+            if(n < s)
+                r = r->left;
+            else if(n > s) {
+                n -= s + 1;
+                r = r->right;
+            } else
+                return r->key;
+        }
+    }
+
+    //
+    // @brief position d'une cle par ordre croissant
+    //
+    // @return la position, ou -1 si la clé est absente
+    //
+    //  Complexité: O(hauteur)
+    //
+    size_t rank(const_reference key) const noexcept {
+        size_t before = 0;
+        for(Node* r = _root; r != nullptr; ) {
+            size_t s = r->left != nullptr ? r->left->nbElements : 0;
+            if(key < r->key)
+                r = r->left;
+            else if(r->key < key) {
+                before += s + 1;
+                r = r->right;
+            } else
+                return before + s;
+        }
+        return -1;
+    }
+
+    //
+    // @brief Parcours symétrique de l'arbre
+    //
+    // @param f une fonction capable d'être appelée en recevant une cle
+    //          en parametre.
+    //
+    //  Complexité: O(n), mémoire supplémentaire O(hauteur)
+    //
+    template < typename Fn >
+    void visitSym(Fn f) const {
+        vector<Node*> path;
+        for(Node* r = _root; r != nullptr || !path.empty(); ) {
+            if(r != nullptr) {
+                path.push_back(r);
+                r = r->left;
+            } else {
+                r = path.back();
+                path.pop_back();
+                f(r->key);
+                r = r->right;
+            }
+        }
+    }
+
+private:
+    //
+    // @brief Recopie le chemin de r à son minimum, sans ce dernier
+    //
+    // @param r la racine du sous arbre d'origine. ne peut pas etre nullptr
+    // @param slot OUT - la racine du sous arbre recopié
+    //
+    static void removeMin(Node* r, Node*& slot) {
+        Node** s = &slot;
+        while(r->left != nullptr) {
+            Node* c = copyOnPath(r, r->nbElements - 1, true);
+            *s = c;
+            s = &c->left;
+            r = r->left;
+        }
+        *s = acquire(r->right);
+    }
+};
@@ -0,0 +1,362 @@
+//
+//  Binary Search Tree partitionné par intervalles de clés
+//
+//  A inclure après abr.cpp et abr_synchronized.cpp.
+//
+
+#include <algorithm>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <stdexcept>
+#include <thread>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+//
+// @brief Arbre partagé entre threads, découpé en P partitions (shards)
+//        d'intervalles de clés consécutifs
+//
+// Chaque partition est un BinarySearchTree protégé par son propre mutex:
+// des écritures dans des partitions différentes s'exécutent en parallèle.
+// Les bornes des partitions sont protégées par un ReadMostlyLock, pris en
+// lecture par toutes les opérations et en écriture seulement pour les
+// déplacer.
+//
+// Tant que l'arbre est petit, une seule partition est utilisée. Quand une
+// partition dépasse 3/2 de la taille moyenne, les bornes sont
+// recalculées pour répartir les clés en parts égales: les partitions sont
+// jointes puis redécoupées par split_at, sans copie de noeud.
+//
+// size, rank et nth_element verrouillent les partitions dans l'ordre et
+// rendent un résultat cohérent. visitSym verrouille une partition à la
+// fois.
+//
+// Trace et TreeStats sont les politiques Trace et Stats des partitions,
+// partagées par toutes les partitions.
+//
+template < typename T,
+           typename Compare = std::less<T>,
+           template < typename > class Allocator = NewDeleteAllocator,
+           typename Balancing = NoBalancing,
+           typename Trace = NoTrace,
+           typename TreeStats = NoStats >
+class ShardedBinarySearchTree {
+public:
+    using tree_type = BinarySearchTree<T, Compare, Allocator, Balancing, Trace, TreeStats>;
+    using value_type = T;
+    using const_reference = const T&;
+
+    static_assert(tree_type::allocator_type::threadSafe,
+                  "les partitions sont jointes et redécoupées: l'allocateur doit etre threadSafe");
+
+private:
+    struct Shard {
+        mutex lock;
+        tree_type tree;
+
+        explicit Shard(const Compare& comp) : tree(comp) {
+        }
+    };
+
+    // une partition est trop grosse au delà de skewNum / skewDen fois la
+    // taille moyenne des P partitions
+    static constexpr size_t skewNum = 3;
+    static constexpr size_t skewDen = 2;
+
+    // taille minimum d'une partition avant de répartir les clés
+    static constexpr size_t rebalanceMin = 1024;
+
+    Compare _comp;
+    vector<unique_ptr<Shard>> _shards;
+    vector<value_type> _bounds;     // la partition i contient [_bounds[i-1], _bounds[i])
+    mutable ReadMostlyLock _layout; // protège _bounds et le nombre de partitions actives
+    atomic<size_t> _size{ 0 };      // indicatif, pour détecter les déséquilibres
+    atomic<size_t> _rebalances{ 0 };
+
+public:
+    //
+    // @brief Construit un arbre vide
+    //
+    // @param shards le nombre maximum de partitions, par défaut le nombre
+    //        de coeurs
+    // @param comp l'ordre des clés, dans les partitions et entre elles
+    //
+    explicit ShardedBinarySearchTree(size_t shards = thread::hardware_concurrency(),
+                                     const Compare& comp = Compare()) : _comp(comp) {
+        _shards.resize(std::max<size_t>(shards, 1));
+        for(auto& s : _shards)
+            s = make_unique<Shard>(_comp);
+    }
+
+    ShardedBinarySearchTree(const ShardedBinarySearchTree&) = delete;
+    ShardedBinarySearchTree& operator = (const ShardedBinarySearchTree&) = delete;
+
+    //
+    // @brief Insertion d'une cle dans l'arbre
+    //
+    // @return vrai si la clé a été insérée, faux si elle était présente
+    //
+    // Peut répartir à nouveau les clés entre les partitions.
+    //
+    //  Complexité: O(hauteur) en général, O(P hauteur) lors d'une
+    //  répartition
+    //
+    bool insert(const_reference key) {
+        bool skewed;
+        {
+            shared_lock<ReadMostlyLock> layout(_layout);
+            Shard& s = shardOf(key);
+            lock_guard<mutex> guard(s.lock);
+            if(!s.tree.emplace(key))
+                return false;
+            size_t total = _size.fetch_add(1, memory_order_relaxed) + 1;
+            skewed = isSkewed(s.tree.size(), total);
+        }
+        if(skewed)
+            rebalance(false);
+        return true;
+    }
+
+    bool deleteElement(const_reference key) {
+        shared_lock<ReadMostlyLock> layout(_layout);
+        Shard& s = shardOf(key);
+        lock_guard<mutex> guard(s.lock);
+        if(!s.tree.deleteElement(key))
+            return false;
+        _size.fetch_sub(1, memory_order_relaxed);
+        return true;
+    }
+
+    bool contains(const_reference key) const {
+        shared_lock<ReadMostlyLock> layout(_layout);
+        Shard& s = shardOf(key);
+        lock_guard<mutex> guard(s.lock);
+        return s.tree.contains(key);
+    }
+
+    //
+    // @brief taille de l'arbre, somme des tailles des partitions
+    //
+    //  Complexité: O(P)
+    //
+    size_t size() const {
+        shared_lock<ReadMostlyLock> layout(_layout);
+        AllShards all(*this, active());
+        size_t total = 0;
+        for(size_t i = 0; i < active(); ++i)
+            total += _shards[i]->tree.size();
+        return total;
+    }
+
+    //
+    // @brief Recherche de la cle minimale.
+    //
+    // @exception std::logic_error si l'arbre est vide
+    //
+    value_type min() const {
+        shared_lock<ReadMostlyLock> layout(_layout);
+        AllShards all(*this, active());
+        for(size_t i = 0; i < active(); ++i)
+            if(_shards[i]->tree.size() != 0)
+                return _shards[i]->tree.min();
+        throw logic_error("empty tree");
+    }
+
+    //
+    // @brief position d'une cle par ordre croissant
+    //
+    // @return la position, ou -1 si la clé est absente
+    //
+    //  Complexité: O(P + hauteur)
+    //
+    size_t rank(const_reference key) const {
+        shared_lock<ReadMostlyLock> layout(_layout);
+        size_t i = shardIndex(key);
+        AllShards before(*this, i + 1);
+        size_t r = _shards[i]->tree.rank(key);
+        if(r == size_t(-1))
+            return r;
+        for(size_t j = 0; j < i; ++j)
+            r += _shards[j]->tree.size();
+        return r;
+    }
+
+    //
+    // @brief cle en position n par ordre croissant
+    //
+    // @exception std::logic_error si n >= size()
+    //
+    //  Complexité: O(P + hauteur)
+    //
+    value_type nth_element(size_t n) const {
+        shared_lock<ReadMostlyLock> layout(_layout);
+        AllShards all(*this, active());
+        for(size_t i = 0; i < active(); ++i) {
+            const tree_type& t = _shards[i]->tree;
+            if(n < t.size())
+                return t.nth_element(n);
+            n -= t.size();
+        }
+        throw logic_error("Erreur: La position est en dehors du tableau.");
+    }
+
+    //
+    // @brief Parcours symétrique de l'arbre
+    //
+    // Les partitions sont parcourues l'une après l'autre, chacune sous son
+    // verrou. Une modification concurrente peut etre vue dans une partition
+    // et pas dans une autre. f ne doit pas accéder à cet arbre.
+    //
+    template < typename Fn >
+    void visitSym(Fn f) const {
+        shared_lock<ReadMostlyLock> layout(_layout);
+        for(size_t i = 0; i < active(); ++i) {
+            lock_guard<mutex> guard(_shards[i]->lock);
+            _shards[i]->tree.visitSym(f);
+        }
+    }
+
+    //
+    // @brief Répartit les clés en parts égales entre les partitions
+    //
+    // Appelé automatiquement par insert quand une partition devient trop
+    // grosse. Bloque toutes les opérations pendant la répartition.
+    //
+    //  Complexité: O(P hauteur)
+    //
+    void rebalance() {
+        rebalance(true);
+    }
+
+    // nombre de partitions utilisées
+    size_t shard_count() const {
+        shared_lock<ReadMostlyLock> layout(_layout);
+        return active();
+    }
+
+    // tailles des partitions utilisées, par ordre de clés
+    vector<size_t> shard_sizes() const {
+        shared_lock<ReadMostlyLock> layout(_layout);
+        AllShards all(*this, active());
+        vector<size_t> sizes;
+        for(size_t i = 0; i < active(); ++i)
+            sizes.push_back(_shards[i]->tree.size());
+        return sizes;
+    }
+
+    // nombre de répartitions effectuées depuis la création
+    size_t rebalance_count() const noexcept {
+        return _rebalances.load(memory_order_relaxed);
+    }
+
+    // contention sur le verrou des bornes
+    ReadMostlyLock::Stats layout_stats() const noexcept {
+        return _layout.stats();
+    }
+
+private:
+    //
+    // @brief Verrouille les partitions 0 à count - 1, dans l'ordre
+    //
+    // Les opérations sur une clé ne prennent qu'un seul verrou de partition:
+    // l'ordre croissant suffit à éviter les interblocages.
+    //
+    class AllShards {
+        const ShardedBinarySearchTree& owner;
+        size_t count;
+
+    public:
+        AllShards(const ShardedBinarySearchTree& owner, size_t n) : owner(owner), count(0) {
+            try {
+                for(; count < n; ++count)
+                    owner._shards[count]->lock.lock();
+            } catch(...) {
+                release();
+                throw;
+            }
+        }
+
+        AllShards(const AllShards&) = delete;
+        AllShards& operator = (const AllShards&) = delete;
+
+        ~AllShards() {
+            release();
+        }
+
+    private:
+        void release() noexcept {
+            while(count != 0)
+                owner._shards[--count]->lock.unlock();
+        }
+    };
+
+    size_t active() const noexcept {
+        return _bounds.size() + 1;
+    }
+
+    size_t shardIndex(const_reference key) const noexcept {
+        return size_t(upper_bound(_bounds.begin(), _bounds.end(), key, _comp) - _bounds.begin());
+    }
+
+    Shard& shardOf(const_reference key) const noexcept {
+        return *_shards[shardIndex(key)];
+    }
+
+    bool isSkewed(size_t shardSize, size_t total) const noexcept {
+        return _shards.size() > 1 && shardSize >= rebalanceMin
+               && shardSize * skewDen * _shards.size() > skewNum * total;
+    }
+
+    //
+    // @param forced faux si appelé par insert: la répartition n'a alors
+    //        lieu que si une partition est encore trop grosse
+    //
+    // Si la copie d'une borne lève une exception, toutes les clés sont
+    // laissées dans la première partition.
+    //
+    void rebalance(bool forced) {
+        lock_guard<ReadMostlyLock> layout(_layout);
+        size_t total = 0;
+        size_t largest = 0;
+        for(size_t i = 0; i < active(); ++i) {
+            total += _shards[i]->tree.size();
+            largest = std::max(largest, _shards[i]->tree.size());
+        }
+        if(!forced && !isSkewed(largest, total))
+            return;
+
+        // au plus une partition par clé, pour que les bornes soient distinctes
+        size_t parts = std::max<size_t>(std::min(_shards.size(), total), 1);
+        vector<value_type> bounds;
+        bounds.reserve(parts - 1);
+
+        tree_type all(_comp);
+        for(size_t i = 0; i < active(); ++i)
+            all = tree_type::join(std::move(all), std::move(_shards[i]->tree));
+
+        size_t i = 0;
+        try {
+            while(i + 1 < parts) {
+                auto halves = all.split_at(total / (parts - i));
+                total -= halves.first.size();
+                // i compte la partition remplie avant la copie de sa borne,
+                // pour que le bloc catch la rejoigne
+                _shards[i++]->tree = std::move(halves.first);
+                all = std::move(halves.second);
+                bounds.push_back(all.min());
+            }
+        } catch(...) {
+            while(i != 0)
+                all = tree_type::join(std::move(_shards[--i]->tree), std::move(all));
+            _shards[0]->tree = std::move(all);
+            _bounds.clear();
+            throw;
+        }
+        _shards[parts - 1]->tree = std::move(all);
+        _bounds.swap(bounds);
+        _rebalances.fetch_add(1, memory_order_relaxed);
+    }
+};
@@ -0,0 +1,344 @@
+//
+//  Binary Search Tree partagé entre threads
+//
+//  A inclure après abr.cpp.
+//
+
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <shared_mutex>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+//
+// @brief Verrou lecteurs / écrivain optimisé pour les lectures
+//
+// Chaque lecteur s'annonce dans le compteur d'une des bandes (stripes), sur
+// sa propre ligne de cache: des lecteurs de threads différents n'écrivent
+// pas dans la meme ligne. Un écrivain lève un drapeau puis attend que toutes
+// les bandes soient vides. Un lecteur qui voit le drapeau se retire et
+// attend: les écrivains ne sont pas affamés par un flot de lectures.
+//
+// Les attentes sont comptées et chronométrées. L'horloge n'est lue que
+// lorsqu'il faut attendre.
+//
+class ReadMostlyLock {
+public:
+    //
+    // @brief Compteurs de contention, cumulés depuis la création ou le
+    //        dernier reset_stats
+    //
+    struct Stats {
+        size_t reads = 0;        // sections de lecture
+        size_t readRetries = 0;  // lecteurs retirés devant un écrivain
+        size_t readWaitNs = 0;   // temps passé par les lecteurs à attendre
+        size_t writes = 0;       // sections d'écriture
+        size_t writeWaits = 0;   // écrivains qui ont du attendre
+        size_t writeWaitNs = 0;  // temps passé par les écrivains à attendre
+    };
+
+private:
+    struct alignas(64) Stripe {
+        atomic<size_t> readers{ 0 };
+        atomic<size_t> reads{ 0 };
+        atomic<size_t> retries{ 0 };
+        atomic<size_t> waitNs{ 0 };
+    };
+
+    vector<Stripe> stripes;
+    atomic<bool> writing{ false };
+    mutex writers;
+    atomic<size_t> writes{ 0 };
+    atomic<size_t> writeWaits{ 0 };
+    atomic<size_t> writeWaitNs{ 0 };
+
+    using Clock = chrono::steady_clock;
+
+    static size_t elapsedNs(Clock::time_point start) noexcept {
+        return size_t(chrono::duration_cast<chrono::nanoseconds>(Clock::now() - start).count());
+    }
+
+    // numéro attribué à chaque thread à sa première lecture
+    static size_t threadIndex() noexcept {
+        static atomic<size_t> next{ 0 };
+        static thread_local size_t index = next.fetch_add(1, memory_order_relaxed);
+        return index;
+    }
+
+    Stripe& ownStripe() noexcept {
+        return stripes[threadIndex() % stripes.size()];
+    }
+
+public:
+    //
+    // @param stripeCount le nombre de bandes, par défaut le nombre de coeurs
+    //
+    explicit ReadMostlyLock(size_t stripeCount = thread::hardware_concurrency())
+            : stripes(std::max<size_t>(stripeCount, 1)) {
+    }
+
+    ReadMostlyLock(const ReadMostlyLock&) = delete;
+    ReadMostlyLock& operator = (const ReadMostlyLock&) = delete;
+
+    void lock_shared() noexcept {
+        Stripe& s = ownStripe();
+        s.reads.fetch_add(1, memory_order_relaxed);
+        s.readers.fetch_add(1);
+        if(!writing.load())
+            return;
+
+        auto start = Clock::now();
+        do {
+            s.readers.fetch_sub(1);
+            s.retries.fetch_add(1, memory_order_relaxed);
+            while(writing.load())
+                this_thread::yield();
+            s.readers.fetch_add(1);
+        } while(writing.load());
+        s.waitNs.fetch_add(elapsedNs(start), memory_order_relaxed);
+    }
+
+    void unlock_shared() noexcept {
+        ownStripe().readers.fetch_sub(1, memory_order_release);
+    }
+
+    void lock() {
+        writes.fetch_add(1, memory_order_relaxed);
+        bool waited = false;
+        Clock::time_point start;
+        if(!writers.try_lock()) {
+            waited = true;
+            start = Clock::now();
+            writers.lock();
+        }
+        writing.store(true);
+        if(!noReaders()) {
+            if(!waited) {
+                waited = true;
+                start = Clock::now();
+            }
+            do
+                this_thread::yield();
+            while(!noReaders());
+        }
+        if(waited) {
+            writeWaits.fetch_add(1, memory_order_relaxed);
+            writeWaitNs.fetch_add(elapsedNs(start), memory_order_relaxed);
+        }
+    }
+
+    void unlock() noexcept {
+        writing.store(false, memory_order_release);
+        writers.unlock();
+    }
+
+    Stats stats() const noexcept {
+        Stats result;
+        for(const Stripe& s : stripes) {
+            result.reads += s.reads.load(memory_order_relaxed);
+            result.readRetries += s.retries.load(memory_order_relaxed);
+            result.readWaitNs += s.waitNs.load(memory_order_relaxed);
+        }
+        result.writes = writes.load(memory_order_relaxed);
+        result.writeWaits = writeWaits.load(memory_order_relaxed);
+        result.writeWaitNs = writeWaitNs.load(memory_order_relaxed);
+        return result;
+    }
+
+    void reset_stats() noexcept {
+        for(Stripe& s : stripes) {
+            s.reads.store(0, memory_order_relaxed);
+            s.retries.store(0, memory_order_relaxed);
+            s.waitNs.store(0, memory_order_relaxed);
+        }
+        writes.store(0, memory_order_relaxed);
+        writeWaits.store(0, memory_order_relaxed);
+        writeWaitNs.store(0, memory_order_relaxed);
+    }
+
+private:
+    bool noReaders() const noexcept {
+        for(const Stripe& s : stripes)
+            if(s.readers.load() != 0)
+                return false;
+        return true;
+    }
+};
+
+//
+// @brief BinarySearchTree partageable entre threads
+//
+// Les lectures (contains, rank, nth_element, visitSym, ...) s'exécutent en
+// parallèle entre elles; les modifications sont exclusives. Les lectures
+// rendent des copies des clés: une référence dans l'arbre ne serait plus
+// protégée une fois le verrou relaché.
+//
+// stats() indique le temps perdu à attendre. Des écrivains qui attendent
+// souvent signalent un arbre à partitionner entre plusieurs verrous.
+//
+// Trace et TreeStats sont les politiques Trace et Stats de l'arbre
+// protégé: Stats désigne ici les compteurs du verrou.
+//
+template < typename T,
+           typename Compare = std::less<T>,
+           template < typename > class Allocator = NewDeleteAllocator,
+           typename Balancing = NoBalancing,
+           typename Trace = NoTrace,
+           typename TreeStats = NoStats >
+class SynchronizedBinarySearchTree {
+public:
+    using tree_type = BinarySearchTree<T, Compare, Allocator, Balancing, Trace, TreeStats>;
+    using value_type = T;
+    using const_reference = const T&;
+    using Stats = ReadMostlyLock::Stats;
+
+private:
+    tree_type _tree;
+    mutable ReadMostlyLock _lock;
+
+public:
+    SynchronizedBinarySearchTree() = default;
+
+    //
+    // @brief Partage un arbre existant, dont le contenu est déplacé
+    //
+    explicit SynchronizedBinarySearchTree(tree_type&& tree) noexcept : _tree(std::move(tree)) {
+    }
+
+    SynchronizedBinarySearchTree(const SynchronizedBinarySearchTree&) = delete;
+    SynchronizedBinarySearchTree& operator = (const SynchronizedBinarySearchTree&) = delete;
+
+    //
+    // @brief Insertion d'une cle dans l'arbre
+    //
+    // @return vrai si la clé a été insérée, faux si elle était présente
+    //
+    bool insert(const_reference key) {
+        lock_guard<ReadMostlyLock> guard(_lock);
+        return _tree.emplace(key);
+    }
+
+    bool deleteElement(const_reference key) {
+        lock_guard<ReadMostlyLock> guard(_lock);
+        return _tree.deleteElement(key);
+    }
+
+    //
+    // @brief Supprime et rend le plus petit element de l'arbre.
+    //
+    // @exception std::logic_error si l'arbre est vide
+    //
+    value_type extractMin() {
+        lock_guard<ReadMostlyLock> guard(_lock);
+        value_type key = _tree.min();
+        _tree.deleteMin();
+        return key;
+    }
+
+    void clear() {
+        lock_guard<ReadMostlyLock> guard(_lock);
+        _tree.clear();
+    }
+
+    bool contains(const_reference key) const {
+        shared_lock<ReadMostlyLock> guard(_lock);
+        return _tree.contains(key);
+    }
+
+    size_t size() const {
+        shared_lock<ReadMostlyLock> guard(_lock);
+        return _tree.size();
+    }
+
+    //
+    // @exception std::logic_error si l'arbre est vide
+    //
+    value_type min() const {
+        shared_lock<ReadMostlyLock> guard(_lock);
+        return _tree.min();
+    }
+
+    //
+    // @exception std::logic_error si n >= size()
+    //
+    value_type nth_element(size_t n) const {
+        shared_lock<ReadMostlyLock> guard(_lock);
+        if(n >= _tree.size())
+            throw logic_error("Erreur: La position est en dehors du tableau.");
+        return _tree.nth_element(n);
+    }
+
+    //
+    // @return la position de key, ou -1 si la clé est absente
+    //
+    size_t rank(const_reference key) const {
+        shared_lock<ReadMostlyLock> guard(_lock);
+        return _tree.rank(key);
+    }
+
+    size_t count_range(const_reference lo, const_reference hi) const {
+        shared_lock<ReadMostlyLock> guard(_lock);
+        return _tree.count_range(lo, hi);
+    }
+
+    //
+    // @brief Parcours symétrique, verrou de lecture tenu pendant tout le
+    //        parcours
+    //
+    // f ne doit pas accéder à cet arbre en écriture.
+    //
+    template < typename Fn >
+    void visitSym(Fn f) const {
+        shared_lock<ReadMostlyLock> guard(_lock);
+        _tree.visitSym(f);
+    }
+
+    template < typename Fn >
+    void visit_range(const_reference lo, const_reference hi, Fn f) const {
+        shared_lock<ReadMostlyLock> guard(_lock);
+        _tree.visit_range(lo, hi, f);
+    }
+
+    //
+    // @brief Appelle f(const tree_type&) sous le verrou de lecture, pour
+    //        grouper plusieurs lectures cohérentes entre elles
+    //
+    // @return le résultat de f, qui ne doit pas référencer l'arbre
+    //
+    template < typename Fn >
+    auto read(Fn f) const {
+        shared_lock<ReadMostlyLock> guard(_lock);
+        return f(static_cast<const tree_type&>(_tree));
+    }
+
+    //
+    // @brief Appelle f(tree_type&) sous le verrou exclusif, par exemple
+    //        pour insert_batch ou balance
+    //
+    template < typename Fn >
+    auto write(Fn f) {
+        lock_guard<ReadMostlyLock> guard(_lock);
+        return f(_tree);
+    }
+
+    //
+    // @brief Copie de l'arbre, cohérente
+    //
+    //  Complexité: O(n), sous le verrou de lecture
+    //
+    tree_type snapshot() const {
+        shared_lock<ReadMostlyLock> guard(_lock);
+        return tree_type(_tree);
+    }
+
+    Stats stats() const noexcept {
+        return _lock.stats();
+    }
+
+    void reset_stats() noexcept {
+        _lock.reset_stats();
+    }
+};
@@ -0,0 +1,1107 @@
+//
+//  Binary Search Tree - mesures de performance
+//
+//  Compilation:
+//      g++ -std=c++17 -O2 -pthread bench.cpp -o bench
+//      g++ -std=c++17 -O2 -pthread -DABR_RECURSIVE bench.cpp -o bench_recursive
+//
+//  Usage:
+//      ./bench <mesure> [n]
+//
+//  Sans argument, la liste des mesures disponibles est affichée. Les
+//  mesures s'affichent sur la sortie d'erreur; la mesure suite écrit en
+//  plus ses résultats en JSON sur la sortie standard:
+//      ./bench suite 100000000 > suite.json
+//
+
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <functional>
+#include <limits>
+#include <map>
+#include <numeric>
+#include <random>
+#include <set>
+#include <string_view>
+#include <sys/resource.h>
+#include <unistd.h>
+#include "abr.cpp"
+#include "abr_persistent.cpp"
+#include "abr_lockfree.cpp"
+#include "abr_synchronized.cpp"
+#include "abr_sharded.cpp"
+
+using namespace std;
+
+namespace {
+
+#ifdef ABR_RECURSIVE
+const char* const variant = "recursive";
+#else
+const char* const variant = "iterative";
+#endif
+
+using Clock = chrono::steady_clock;
+
+//
+// @brief Temps d'exécution de f, en nanosecondes
+//
+template < typename Fn >
+double timeIt(Fn f) {
+    auto start = Clock::now();
+    f();
+    return chrono::duration<double, nano>(Clock::now() - start).count();
+}
+
+void report(const string& op, const string& keys, size_t n, double ns, size_t ops) {
+    cerr << left << setw(10) << variant << setw(14) << op << setw(10) << keys
+         << right << setw(10) << n << setw(12) << fixed << setprecision(1)
+         << ns / double(ops) << " ns/op" << endl;
+}
+
+//
+// @brief 1, 2, 4, ... jusqu'au nombre de coeurs disponibles
+//
+vector<unsigned> threadCounts() {
+    unsigned cores = max(thread::hardware_concurrency(), 1u);
+    vector<unsigned> counts;
+    for(unsigned threads = 1; threads < cores; threads *= 2)
+        counts.push_back(threads);
+    counts.push_back(cores);
+    return counts;
+}
+
+string threadLabel(unsigned threads) {
+    return to_string(threads) + (threads == 1 ? " thread" : " threads");
+}
+
+vector<int> shuffled(size_t n, unsigned seed) {
+    vector<int> keys(n);
+    iota(keys.begin(), keys.end(), 0);
+    shuffle(keys.begin(), keys.end(), mt19937(seed));
+    return keys;
+}
+
+//
+// @brief Opérations de base, versions itératives ou récursives selon
+//        ABR_RECURSIVE, sur des clés aléatoires puis triées
+//
+// Les clés triées produisent un arbre dégénéré de hauteur n. La version
+// récursive peut alors dépasser la pile pour de grandes valeurs de n.
+//
+void hotPaths(size_t n) {
+    for(const char* order : { "random", "sorted" }) {
+        vector<int> keys = shuffled(n, 42);
+        if(string(order) == "sorted")
+            sort(keys.begin(), keys.end());
+
+        BinarySearchTree<int> tree;
+        report("insert", order, n, timeIt([&] { for(int k : keys) tree.insert(k); }), n);
+
+        size_t found = 0;
+        report("contains", order, n, timeIt([&] { for(int k : keys) found += tree.contains(k); }), n);
+
+        size_t sum = 0;
+        report("rank", order, n, timeIt([&] { for(int k : keys) sum += tree.rank(k); }), n);
+        report("nth_element", order, n, timeIt([&] {
+            for(size_t i = 0; i < n; ++i) sum += size_t(tree.nth_element(i));
+        }), n);
+
+        report("copy+delete", order, n, timeIt([&] { BinarySearchTree<int> copy(tree); }), n);
+        report("linearize", order, n, timeIt([&] { tree.linearize(); }), n);
+        report("balance", order, n, timeIt([&] { tree.balance(); }), n);
+
+        report("deleteElement", order, n, timeIt([&] { for(int k : keys) tree.deleteElement(k); }), n);
+        if(found != n || tree.size() != 0 || sum == 0)
+            throw logic_error("résultat inattendu");
+    }
+}
+
+//
+// @brief insert_batch: descente par clé contre fusion, pour des lots de
+//        taille croissante dans un arbre de n clés aléatoires
+//
+// Le point de bascule mesuré fixe batchMergeFactor dans abr.cpp.
+//
+void batch(size_t n) {
+    using Tree = BinarySearchTree<int>;
+    mt19937 gen(7);
+    vector<int> keys = shuffled(n, 3);
+    for(int& k : keys)
+        k *= 2; // les lots utilisent des clés impaires, absentes de l'arbre
+
+    for(size_t m = max<size_t>(n / 4096, 1); m <= n; m *= 2) {
+        vector<int> lot(m);
+        for(int& k : lot)
+            k = 2 * int(gen() % n) + 1;
+
+        // les trois arbres sont construits de la meme manière: une copie
+        // aurait ses noeuds contigus dans l'ordre préfixe et fausserait
+        // la comparaison
+        string label = "m=" + to_string(m);
+        Tree perKey, merge, auto_;
+        for(int k : keys) {
+            perKey.insert(k);
+            merge.insert(k);
+            auto_.insert(k);
+        }
+
+        report("perKey", label, n, timeIt([&] {
+            perKey.insert_batch(lot.begin(), lot.end(), Tree::BatchMode::PerKey);
+        }), m);
+        report("merge", label, n, timeIt([&] {
+            merge.insert_batch(lot.begin(), lot.end(), Tree::BatchMode::Merge);
+        }), m);
+        report("auto", label, n, timeIt([&] {
+            auto_.insert_batch(lot.begin(), lot.end());
+        }), m);
+    }
+}
+
+//
+// @brief split suivi de join sur un arbre de n clés aléatoires, selon la
+//        politique d'équilibrage, et un parcours du meme arbre pour
+//        comparaison
+//
+template < typename Balancing >
+void splitJoinWith(const char* name, size_t n) {
+    using Tree = BinarySearchTree<int, less<int>, NewDeleteAllocator, Balancing>;
+    Tree tree;
+    for(int k : shuffled(n, 14))
+        tree.insert(k);
+
+    const size_t ops = 1000;
+    report("split+join", name, n, timeIt([&] {
+        for(size_t i = 0; i < ops; ++i) {
+            auto parts = tree.split(int(i * 104729 % n));
+            tree = Tree::join(std::move(parts.first), std::move(parts.second));
+        }
+    }), ops);
+    size_t sum = 0;
+    report("traversal", name, n, timeIt([&] {
+        tree.visitSym([&](int k) { sum += size_t(k); });
+    }), 1);
+    if(tree.size() != n || sum == 0)
+        throw logic_error("résultat inattendu");
+}
+
+void splitJoin(size_t n) {
+    splitJoinWith<NoBalancing>("none", n);
+    splitJoinWith<AVLBalancing>("avl", n);
+    splitJoinWith<ScapegoatBalancing<>>("scapegoat", n);
+}
+
+//
+// @brief set_union, set_intersection et set_difference de deux arbres de
+//        n clés dont la moitié sont communes, de 1 à N threads
+//
+// N est le nombre de coeurs disponibles. La référence "probe" parcourt a
+// et cherche chaque clé dans b par contains. La dernière mesure réunit un
+// arbre scapegoat de n clés et 100 autres clés, en O(m log(n/m + 1)) pour
+// m = 100.
+//
+void setOps(size_t n) {
+    using Tree = BinarySearchTree<int>;
+    vector<int> keys = shuffled(2 * n, 11);
+    Tree a, b;
+    for(size_t i = 0; i < n; ++i) {
+        a.insert(keys[i]);
+        b.insert(keys[i + n / 2]);
+    }
+
+    report("probe", "1 thread", n, timeIt([&] {
+        vector<int> common;
+        for(int k : a)
+            if(b.contains(k))
+                common.push_back(k);
+        Tree result(common.begin(), common.end());
+    }), n);
+
+    for(unsigned threads : threadCounts()) {
+        TaskPool pool(threads);
+        string label = threadLabel(threads);
+        for(auto op : { &Tree::set_union, &Tree::set_intersection, &Tree::set_difference }) {
+            const char* name = op == &Tree::set_union ? "union"
+                             : op == &Tree::set_intersection ? "intersection" : "difference";
+            Tree x = a, y = b, result;
+            report(name, label, n, timeIt([&] {
+                result = op(std::move(x), std::move(y), pool);
+            }), n);
+        }
+    }
+
+    using Scapegoat = BinarySearchTree<int, less<int>, NewDeleteAllocator, ScapegoatBalancing<>>;
+    Scapegoat large, small, result;
+    for(size_t i = 0; i < n; ++i)
+        large.insert(keys[i]);
+    for(size_t i = n; i < n + 100; ++i)
+        small.insert(keys[i]);
+    report("union", "100 keys", n, timeIt([&] {
+        result = Scapegoat::set_union(std::move(large), std::move(small));
+    }), 100);
+    if(result.size() != n + 100)
+        throw logic_error("résultat inattendu");
+}
+
+//
+// @brief balance() contre balance(pool), de 1 à N threads, sur un arbre de
+//        n clés aléatoires
+//
+// Chaque mesure reconstruit l'arbre par insertions: une copie aurait des
+// noeuds contigus et un arbre déjà équilibré se parcourt plus vite.
+//
+void parallelBalance(size_t n) {
+    vector<int> keys = shuffled(n, 12);
+    auto build = [&] {
+        BinarySearchTree<int> tree;
+        for(int k : keys)
+            tree.insert(k);
+        return tree;
+    };
+
+    {
+        BinarySearchTree<int> tree = build();
+        report("balance", "serial", n, timeIt([&] { tree.balance(); }), n);
+    }
+    for(unsigned threads : threadCounts()) {
+        TaskPool pool(threads);
+        BinarySearchTree<int> tree = build();
+        report("balance", threadLabel(threads), n, timeIt([&] { tree.balance(pool); }), n);
+    }
+}
+
+//
+// @brief Copie et destruction d'un arbre de n clés aléatoires, de 1 à N
+//        threads
+//
+void parallelCopy(size_t n) {
+    BinarySearchTree<int> tree;
+    for(int k : shuffled(n, 13))
+        tree.insert(k);
+
+    for(unsigned threads : threadCounts()) {
+        TaskPool pool(threads);
+        unique_ptr<BinarySearchTree<int>> copy;
+        report("copy", threadLabel(threads), n, timeIt([&] {
+            copy = make_unique<BinarySearchTree<int>>(tree, pool);
+        }), n);
+        report("clear", threadLabel(threads), n, timeIt([&] { copy->clear(pool); }), n);
+    }
+}
+
+//
+// @brief Temps de destruction vu par l'appelant, immédiate ou confiée à
+//        un Reclaimer, d'un arbre de n clés aléatoires
+//
+void deferred(size_t n) {
+    vector<int> keys = shuffled(n, 14);
+    Reclaimer reclaimer;
+    for(bool defer : { false, true }) {
+        auto tree = make_unique<BinarySearchTree<int>>();
+        for(int k : keys)
+            tree->insert(k);
+        if(defer)
+            tree->set_reclaimer(&reclaimer);
+        report("destroy", defer ? "deferred" : "inline", n, timeIt([&] { tree.reset(); }), n);
+    }
+    report("flush", "deferred", n, timeIt([&] { reclaimer.flush(); }), n);
+}
+
+//
+// @brief Instantané puis 1000 mises à jour: copie complète d'un
+//        BinarySearchTree contre copie partagée d'un arbre persistant
+//
+void persistent(size_t n) {
+    vector<int> keys = shuffled(n, 15);
+    BinarySearchTree<int> tree;
+    PersistentBinarySearchTree<int> shared;
+    report("insert", "copy", n, timeIt([&] { for(int k : keys) tree.insert(k); }), n);
+    report("insert", "persistent", n, timeIt([&] { for(int k : keys) shared.insert(k); }), n);
+
+    const size_t updates = 1000;
+    report("snapshot", "copy", n, timeIt([&] {
+        BinarySearchTree<int> snapshot(tree);
+        for(size_t i = 0; i < updates; ++i)
+            tree.deleteElement(keys[i]);
+    }), updates);
+    report("snapshot", "persistent", n, timeIt([&] {
+        PersistentBinarySearchTree<int> snapshot(shared);
+        for(size_t i = 0; i < updates; ++i)
+            shared.deleteElement(keys[i]);
+    }), updates);
+}
+
+//
+// @brief Insertion de n clés std::string de 64 caractères: copiées,
+//        déplacées ou construites dans le noeud par emplace
+//
+void moves(size_t n) {
+    vector<string> keys;
+    for(int k : shuffled(n, 19)) {
+        string key = to_string(k);
+        keys.push_back(string(64 - key.size(), '0') + key);
+    }
+    for(const char* mode : { "copy", "move", "emplace" }) {
+        vector<string> source = keys;
+        BinarySearchTree<string> tree;
+        report("insert", mode, n, timeIt([&] {
+            for(string& key : source) {
+                if(mode[0] == 'c')
+                    tree.insert(key);
+                else if(mode[0] == 'm')
+                    tree.insert(std::move(key));
+                else
+                    tree.emplace(key.data(), key.size());
+            }
+        }), n);
+        if(tree.size() != n)
+            throw logic_error("résultat inattendu");
+    }
+}
+
+//
+// @brief contains pour n clés de 64 caractères reçues comme string_view:
+//        std::string temporaire avec std::less<string>, ou recherche
+//        directe avec le comparateur transparent std::less<>
+//
+void transparent(size_t n) {
+    vector<string> keys;
+    for(int k : shuffled(n, 20)) {
+        string key = to_string(k);
+        keys.push_back(string(64 - key.size(), '0') + key);
+    }
+    vector<string_view> queries(keys.begin(), keys.end());
+    shuffle(queries.begin(), queries.end(), mt19937(21));
+
+    BinarySearchTree<string> plain;
+    BinarySearchTree<string, less<>> heterogeneous;
+    for(const string& key : keys) {
+        plain.insert(key);
+        heterogeneous.insert(key);
+    }
+
+    size_t found = 0;
+    report("contains", "string", n, timeIt([&] {
+        for(string_view q : queries) found += plain.contains(string(q));
+    }), n);
+    report("contains", "less<>", n, timeIt([&] {
+        for(string_view q : queries) found += heterogeneous.contains(q);
+    }), n);
+    if(found != 2 * n)
+        throw logic_error("résultat inattendu");
+}
+
+//
+// @brief insert puis destruction de n clés aléatoires selon la politique
+//        de traçage
+//
+// CoutTrace écrit sur la sortie standard, à rediriger vers /dev/null.
+//
+template < typename Trace, template < typename > class Allocator >
+void traceWith(const string& name, const vector<int>& keys) {
+    size_t n = keys.size();
+    report("insert+clear", name, n, timeIt([&] {
+        BinarySearchTree<int, less<int>, Allocator, NoBalancing, Trace> tree;
+        for(int k : keys) tree.insert(k);
+    }), n);
+}
+
+void trace(size_t n) {
+    vector<int> keys = shuffled(n, 23);
+    traceWith<NoTrace, NewDeleteAllocator>("none", keys);
+    traceWith<CountingTrace<>, NewDeleteAllocator>("counting", keys);
+    traceWith<RingBufferTrace<>, NewDeleteAllocator>("ring", keys);
+    traceWith<CoutTrace, NewDeleteAllocator>("cout", keys);
+    traceWith<NoTrace, PoolAllocator>("none+pool", keys);
+    traceWith<CountingTrace<>, PoolAllocator>("count+pool", keys);
+}
+
+//
+// @brief insert, contains, rank, nth_element et deleteElement sans puis
+//        avec OperationStats, et cout d'un instantané
+//
+template < typename Stats >
+void statsWith(const string& name, const vector<int>& keys) {
+    size_t n = keys.size();
+    BinarySearchTree<int, less<int>, NewDeleteAllocator, NoBalancing, NoTrace, Stats> tree;
+    size_t sum = 0;
+    report("insert", name, n, timeIt([&] { for(int k : keys) tree.insert(k); }), n);
+    report("contains", name, n, timeIt([&] { for(int k : keys) sum += tree.contains(k); }), n);
+    report("rank", name, n, timeIt([&] { for(int k : keys) sum += tree.rank(k); }), n);
+    report("nth_element", name, n, timeIt([&] {
+        for(size_t i = 0; i < n; ++i) sum += size_t(tree.nth_element(i));
+    }), n);
+    report("deleteElement", name, n, timeIt([&] { for(int k : keys) sum += tree.deleteElement(k); }), n);
+    if(sum == 0 || tree.size() != 0)
+        throw logic_error("résultat inattendu");
+}
+
+void stats(size_t n) {
+    vector<int> keys = shuffled(n, 24);
+    statsWith<NoStats>("none", keys);
+    statsWith<OperationStats<>>("stats", keys);
+
+    const size_t snapshots = 1000;
+    size_t calls = 0;
+    report("snapshot", "stats", n, timeIt([&] {
+        for(size_t i = 0; i < snapshots; ++i)
+            calls += OperationStats<>::snapshot()[TreeOperation::contains].calls;
+    }), snapshots);
+    if(calls != snapshots * n)
+        throw logic_error("résultat inattendu");
+}
+
+struct AutoSubtree {};
+struct AutoWhole {};
+
+// rééquilibrages automatiques et leur durée cumulée, via onRebalance
+size_t autoRebalances = 0;
+size_t autoRebalanceNs = 0;
+
+template < typename Tag >
+void countRebalance(const typename AutoBalancing<Tag>::Event& e) {
+    ++autoRebalances;
+    autoRebalanceNs += e.ns;
+}
+
+//
+// @brief insert puis contains de clés aléatoires puis triées selon la
+//        politique d'équilibrage
+//
+template < typename Balancing >
+void balanceWith(const string& name, size_t n) {
+    for(const char* order : { "random", "sorted" }) {
+        vector<int> keys = shuffled(n, 25);
+        if(string(order) == "sorted")
+            sort(keys.begin(), keys.end());
+
+        autoRebalances = autoRebalanceNs = 0;
+        BinarySearchTree<int, less<int>, NewDeleteAllocator, Balancing> tree;
+        report("insert", name, n, timeIt([&] { for(int k : keys) tree.insert(k); }), n);
+        size_t found = 0;
+        report("contains", name, n, timeIt([&] { for(int k : keys) found += tree.contains(k); }), n);
+        cerr << setw(24) << "" << left << setw(10) << order << "height " << tree.height();
+        if(autoRebalances != 0)
+            cerr << ", " << autoRebalances << " rebalances, " << fixed << setprecision(1)
+                 << double(autoRebalanceNs) / 1e6 << " ms";
+        cerr << endl;
+        if(found != n)
+            throw logic_error("résultat inattendu");
+    }
+}
+
+//
+// Sans équilibrage, les clés triées donnent un arbre dégénéré: n reste
+// petit par défaut.
+//
+void autoBalance(size_t n) {
+    AutoBalancing<AutoSubtree>::set_on_rebalance(countRebalance<AutoSubtree>);
+    AutoBalancing<AutoWhole>::set_on_rebalance(countRebalance<AutoWhole>);
+    AutoBalancing<AutoWhole>::set_thresholds({ 2.0, 64, true });
+
+    balanceWith<NoBalancing>("none", n);
+    balanceWith<AutoBalancing<AutoSubtree>>("auto", n);
+    balanceWith<AutoBalancing<AutoWhole>>("auto-whole", n);
+    balanceWith<ScapegoatBalancing<>>("scapegoat", n);
+    balanceWith<AVLBalancing>("avl", n);
+}
+
+//
+// @brief Ordre des chaines qui compte ses appels, en deux comparaisons
+//        par noeud (operator() seulement)
+//
+struct CountingLess {
+    size_t* calls;
+
+    bool operator () (const string& a, const string& b) const {
+        ++*calls;
+        return a < b;
+    }
+};
+
+//
+// @brief Meme ordre, avec une comparaison à trois issues
+//
+struct CountingThreeWay : CountingLess {
+    int compare(const string& a, const string& b) const {
+        ++*calls;
+        return a.compare(b);
+    }
+};
+
+//
+// @brief Appels au comparateur et temps par opération, sur des clés de 64
+//        caractères à long préfixe commun, avant (deux comparaisons par
+//        noeud) et après (une comparaison à trois issues)
+//
+template < typename Compare >
+void countComparisons(const string& name, const vector<string>& keys) {
+    size_t n = keys.size();
+    size_t calls = 0;
+    BinarySearchTree<string, Compare> tree(Compare{ &calls });
+    size_t found = 0;
+
+    auto measure = [&](const string& op, auto f) {
+        calls = 0;
+        double ns = timeIt(f);
+        report(op, name, n, ns, n);
+        cerr << setw(44) << "" << setw(12) << fixed << setprecision(1)
+             << double(calls) / double(n) << " cmp/op" << endl;
+    };
+    measure("insert", [&] {
+        for(const string& key : keys) tree.insert(key);
+    });
+    measure("contains", [&] {
+        for(const string& key : keys) found += tree.contains(key);
+    });
+    measure("rank", [&] {
+        for(const string& key : keys) found += tree.rank(key) != size_t(-1);
+    });
+    measure("deleteElement", [&] {
+        for(const string& key : keys) found += tree.deleteElement(key);
+    });
+    if(found != 3 * n)
+        throw logic_error("résultat inattendu");
+}
+
+void comparisons(size_t n) {
+    vector<string> keys;
+    for(int k : shuffled(n, 22)) {
+        string key = to_string(k);
+        keys.push_back(string(64 - key.size(), '0') + key);
+    }
+    countComparisons<CountingLess>("less", keys);
+    countComparisons<CountingThreeWay>("three-way", keys);
+}
+
+//
+// @brief BinarySearchTree protégé par un mutex global, la référence des
+//        mesures lockfree et synchronized
+//
+class LockedTree {
+    mutex lock;
+    BinarySearchTree<int> tree;
+
+public:
+    bool insert(int key) {
+        lock_guard<mutex> guard(lock);
+        return tree.emplace(key);
+    }
+
+    bool contains(int key) {
+        lock_guard<mutex> guard(lock);
+        return tree.contains(key);
+    }
+
+    bool deleteElement(int key) {
+        lock_guard<mutex> guard(lock);
+        return tree.deleteElement(key);
+    }
+};
+
+// les arbres sans statistiques de contention n'affichent rien
+template < typename Tree >
+void resetContention(Tree&) {
+}
+
+template < typename Tree >
+void reportContention(const Tree&) {
+}
+
+template < typename T >
+void resetContention(SynchronizedBinarySearchTree<T>& tree) {
+    tree.reset_stats();
+}
+
+//
+// @brief Part des lectures et des écritures qui ont du attendre, et temps
+//        moyen d'attente par opération
+//
+template < typename T >
+void reportContention(const SynchronizedBinarySearchTree<T>& tree) {
+    auto s = tree.stats();
+    cerr << setw(34) << "" << "reads: " << setprecision(2) << 100.0 * double(s.readRetries) / double(max<size_t>(s.reads, 1))
+         << "% retried, " << setprecision(1) << double(s.readWaitNs) / double(max<size_t>(s.reads, 1)) << " ns wait/op; "
+         << "writes: " << setprecision(2) << 100.0 * double(s.writeWaits) / double(max<size_t>(s.writes, 1))
+         << "% waited, " << setprecision(1) << double(s.writeWaitNs) / double(max<size_t>(s.writes, 1)) << " ns wait/op" << endl;
+}
+
+//
+// @brief n opérations réparties entre 1 à N threads (au moins 4) sur des
+//        clés de [0, 2^16), pour différentes proportions de lectures
+//
+template < typename Tree >
+void mixedOps(const string& name, size_t n) {
+    const int range = 1 << 16;
+    unsigned cores = max(thread::hardware_concurrency(), 4u);
+    for(int readPercent : { 90, 50, 0 }) {
+        for(unsigned threads = 1; threads <= cores; threads *= 2) {
+            Tree tree;
+            for(int k : shuffled(range, 16))
+                if(k % 2 == 0)
+                    tree.insert(k);
+            resetContention(tree);
+
+            atomic<size_t> hits{ 0 }; // opérations réussies, utilisées pour que rien ne soit éliminé
+            double ns = timeIt([&] {
+                vector<thread> workers;
+                for(unsigned t = 0; t < threads; ++t)
+                    workers.emplace_back([&, t] {
+                        mt19937 gen(t);
+                        size_t own = 0;
+                        for(size_t i = t; i < n; i += threads) {
+                            int key = int(gen() % range);
+                            int op = int(gen() % 100);
+                            if(op < readPercent)
+                                own += tree.contains(key);
+                            else if((op - readPercent) % 2 == 0)
+                                own += tree.insert(key);
+                            else
+                                own += tree.deleteElement(key);
+                        }
+                        hits += own;
+                    });
+                for(thread& w : workers)
+                    w.join();
+            });
+            if(hits == 0)
+                throw logic_error("résultat inattendu");
+            report(name, to_string(readPercent) + "% r", threads, ns, n);
+            reportContention(tree);
+        }
+    }
+}
+
+//
+// @brief SynchronizedBinarySearchTree contre un BinarySearchTree sous
+//        mutex. La troisième colonne est le nombre de threads.
+//
+void synchronized(size_t n) {
+    mixedOps<LockedTree>("mutex", n);
+    mixedOps<SynchronizedBinarySearchTree<int>>("rwlock", n);
+}
+
+//
+// @brief Une partition par thread de la mesure, au moins 4
+//
+struct ShardedTree : ShardedBinarySearchTree<int> {
+    ShardedTree() : ShardedBinarySearchTree<int>(max(thread::hardware_concurrency(), 4u)) {
+    }
+};
+
+//
+// @brief ShardedBinarySearchTree contre un BinarySearchTree sous mutex.
+//        La troisième colonne est le nombre de threads.
+//
+void sharded(size_t n) {
+    mixedOps<LockedTree>("mutex", n);
+    mixedOps<ShardedTree>("sharded", n);
+}
+
+//
+// @brief LockFreeBinarySearchTree contre un BinarySearchTree sous mutex.
+//        La troisième colonne est le nombre de threads.
+//
+void lockFree(size_t n) {
+    mixedOps<LockedTree>("mutex", n);
+    mixedOps<LockFreeBinarySearchTree<int>>("lockfree", n);
+}
+
+//
+// @brief Mémoire résidente actuelle du processus, en Ko. 0 si elle n'est
+//        pas disponible.
+//
+size_t residentKb() {
+#ifdef __linux__
+    ifstream statm("/proc/self/statm");
+    size_t pages = 0;
+    size_t resident = 0;
+    statm >> pages >> resident;
+    return resident * size_t(sysconf(_SC_PAGESIZE)) / 1024;
+#else
+    return 0;
+#endif
+}
+
+//
+// @brief Maximum de la mémoire résidente depuis le démarrage, en Ko
+//
+size_t peakResidentKb() {
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+#ifdef __APPLE__
+    return size_t(usage.ru_maxrss) / 1024; // en octets sous macOS
+#else
+    return size_t(usage.ru_maxrss);
+#endif
+}
+
+//
+// @brief Rangs zipfiens dans [0, n), les petits rangs étant les plus
+//        fréquents
+//
+// Méthode de Gray et al., "Quickly generating billion-record synthetic
+// databases" (1994): la constante zeta(n) coute O(n) une fois, puis chaque
+// tirage O(1), sans table.
+//
+class Zipf {
+    size_t n;
+    double theta;
+    double zetan;
+    double alpha;
+    double eta;
+
+    static double zeta(size_t n, double theta) {
+        double sum = 0;
+        for(size_t i = 1; i <= n; ++i)
+            sum += 1 / pow(double(i), theta);
+        return sum;
+    }
+
+public:
+    explicit Zipf(size_t n, double theta = 0.99)
+            : n(n), theta(theta), zetan(zeta(n, theta)), alpha(1 / (1 - theta)),
+              eta((1 - pow(2.0 / double(n), 1 - theta)) / (1 - zeta(2, theta) / zetan)) {
+    }
+
+    template < typename Gen >
+    size_t operator () (Gen& gen) {
+        double u = uniform_real_distribution<double>(0, 1)(gen);
+        double uz = u * zetan;
+        if(uz < 1)
+            return 0;
+        if(uz < 1 + pow(0.5, theta))
+            return 1;
+        return std::min(n - 1, size_t(double(n) * pow(eta * u - eta + 1, alpha)));
+    }
+};
+
+//
+// Ordres d'insertion des clés de la suite:
+//   - uniform: clés tirées uniformément dans [0, 2^31)
+//   - sorted, reverse: 0 à n - 1, croissantes ou décroissantes
+//   - zipf: rangs zipfiens (theta 0.99), dispersés par hachage. Beaucoup
+//     de doublons.
+//   - clustered: séquences croissantes de clusterSize clés consécutives,
+//     les séquences dans un ordre aléatoire
+//
+const char* const distributions[] = { "uniform", "sorted", "reverse", "zipf", "clustered" };
+
+const size_t clusterSize = 1000;
+
+vector<int> keysFor(const string& distribution, size_t n, unsigned seed) {
+    mt19937 gen(seed);
+    vector<int> keys(n);
+    if(distribution == "uniform") {
+        uniform_int_distribution<int> uniform(0, numeric_limits<int>::max());
+        for(int& k : keys)
+            k = uniform(gen);
+    } else if(distribution == "sorted") {
+        iota(keys.begin(), keys.end(), 0);
+    } else if(distribution == "reverse") {
+        iota(keys.rbegin(), keys.rend(), 0);
+    } else if(distribution == "zipf") {
+        Zipf zipf(n);
+        for(int& k : keys)
+            k = int(uint32_t(zipf(gen) * 2654435761u) >> 1);
+    } else {
+        vector<size_t> clusters((n + clusterSize - 1) / clusterSize);
+        iota(clusters.begin(), clusters.end(), 0);
+        shuffle(clusters.begin(), clusters.end(), gen);
+        size_t i = 0;
+        for(size_t c : clusters)
+            for(size_t j = 0; j < clusterSize && i < n; ++j)
+                keys[i++] = int(c * 4 * clusterSize + j);
+    }
+    return keys;
+}
+
+//
+// Adaptateurs donnant la meme interface aux structures comparées
+//
+template < typename Tree >
+struct TreeSuite {
+    // rank et nth_element en O(n) par opération
+    static constexpr bool linearRank = false;
+    // deleteElement et deleteMin en O(n) par opération
+    static constexpr bool linearErase = false;
+    static constexpr bool balances = true;
+
+    Tree tree;
+
+    void build(const vector<int>& keys) {
+        for(int k : keys)
+            tree.insert(k);
+    }
+    bool contains(int k) const {
+        return tree.contains(k);
+    }
+    bool erase(int k) {
+        return tree.deleteElement(k);
+    }
+    void deleteMin() {
+        tree.deleteMin();
+    }
+    size_t rank(int k) const {
+        return tree.rank(k);
+    }
+    int nth(size_t i) const {
+        return tree.nth_element(i);
+    }
+    void balance() {
+        tree.balance();
+    }
+    template < typename Fn >
+    void visit(Fn f) const {
+        tree.visitSym(f);
+    }
+    size_t size() const {
+        return tree.size();
+    }
+};
+
+struct SetSuite {
+    static constexpr bool linearRank = true;
+    static constexpr bool linearErase = false;
+    static constexpr bool balances = false;
+
+    set<int> tree;
+
+    void build(const vector<int>& keys) {
+        for(int k : keys)
+            tree.insert(k);
+    }
+    bool contains(int k) const {
+        return tree.count(k) != 0;
+    }
+    bool erase(int k) {
+        return tree.erase(k) != 0;
+    }
+    void deleteMin() {
+        tree.erase(tree.begin());
+    }
+    size_t rank(int k) const {
+        auto it = tree.find(k);
+        return it == tree.end() ? size_t(-1) : size_t(distance(tree.begin(), it));
+    }
+    int nth(size_t i) const {
+        return *next(tree.begin(), ptrdiff_t(i));
+    }
+    void balance() {
+    }
+    template < typename Fn >
+    void visit(Fn f) const {
+        for(int k : tree)
+            f(k);
+    }
+    size_t size() const {
+        return tree.size();
+    }
+};
+
+//
+// Le vecteur trié est construit en bloc (tri puis suppression des
+// doublons): l'insertion une à une couterait O(n) par clé.
+//
+struct VectorSuite {
+    static constexpr bool linearRank = false;
+    static constexpr bool linearErase = true;
+    static constexpr bool balances = false;
+
+    vector<int> keys;
+
+    void build(const vector<int>& source) {
+        keys = source;
+        sort(keys.begin(), keys.end());
+        keys.erase(unique(keys.begin(), keys.end()), keys.end());
+    }
+    bool contains(int k) const {
+        return binary_search(keys.begin(), keys.end(), k);
+    }
+    bool erase(int k) {
+        auto it = lower_bound(keys.begin(), keys.end(), k);
+        if(it == keys.end() || *it != k)
+            return false;
+        keys.erase(it);
+        return true;
+    }
+    void deleteMin() {
+        keys.erase(keys.begin());
+    }
+    size_t rank(int k) const {
+        auto it = lower_bound(keys.begin(), keys.end(), k);
+        return it == keys.end() || *it != k ? size_t(-1) : size_t(it - keys.begin());
+    }
+    int nth(size_t i) const {
+        return keys[i];
+    }
+    void balance() {
+    }
+    template < typename Fn >
+    void visit(Fn f) const {
+        for(int k : keys)
+            f(k);
+    }
+    size_t size() const {
+        return keys.size();
+    }
+};
+
+//
+// @brief Ecrit une mesure de la suite en JSON sur cout, et en clair sur
+//        cerr
+//
+// Les mesures forment un tableau JSON, ouvert par le premier appel et
+// fermé par closeRecords. peak_rss_kb est le maximum depuis le début du
+// processus: rss_kb, la mémoire au moment de la mesure, distingue mieux
+// les structures.
+//
+bool firstRecord = true;
+
+void record(const string& structure, const string& distribution, size_t n,
+            const string& op, size_t ops, double ns) {
+    report(op, distribution, n, ns, ops);
+    cout << (firstRecord ? "[\n" : ",\n") << fixed << setprecision(1)
+         << "  { \"variant\": \"" << variant << "\", \"structure\": \"" << structure
+         << "\", \"distribution\": \"" << distribution << "\", \"n\": " << n
+         << ", \"op\": \"" << op << "\", \"ops\": " << ops
+         << ", \"ns_per_op\": " << ns / double(ops)
+         << ", \"ops_per_s\": " << double(ops) * 1e9 / std::max(ns, 1.0)
+         << ", \"rss_kb\": " << residentKb() << ", \"peak_rss_kb\": " << peakResidentKb() << " }";
+    firstRecord = false;
+}
+
+void closeRecords() {
+    cout << (firstRecord ? "[\n]" : "\n]") << endl;
+}
+
+//
+// @brief Mesure toutes les opérations d'une structure sur les clés keys
+//
+// Les opérations en O(n) (rank et nth_element de std::set, suppressions
+// du vecteur) sont mesurées sur moins de clés pour que les grandes
+// tailles restent praticables. deleteElement et deleteMin s'appliquent à
+// la copie.
+//
+template < typename Suite >
+void measureSuite(const string& structure, const string& distribution, const vector<int>& keys) {
+    size_t n = keys.size();
+    size_t fastOps = std::min<size_t>(n, 1000000);
+    size_t linearOps = std::max<size_t>(1, std::min<size_t>(n, 10000000 / n));
+    cerr << structure << endl;
+
+    Suite s;
+    record(structure, distribution, n, "insert", n, timeIt([&] { s.build(keys); }));
+    size_t m = s.size();
+
+    vector<int> queries(fastOps);
+    mt19937 gen(26);
+    uniform_int_distribution<size_t> anyKey(0, n - 1);
+    for(int& q : queries)
+        q = keys[anyKey(gen)];
+    vector<size_t> positions(fastOps);
+    uniform_int_distribution<size_t> anyPosition(0, m - 1);
+    for(size_t& p : positions)
+        p = anyPosition(gen);
+
+    size_t found = 0;
+    record(structure, distribution, n, "contains", fastOps, timeIt([&] {
+        for(int q : queries) found += s.contains(q);
+    }));
+    size_t rankOps = Suite::linearRank ? linearOps : fastOps;
+    size_t sum = 0;
+    record(structure, distribution, n, "rank", rankOps, timeIt([&] {
+        for(size_t i = 0; i < rankOps; ++i) sum += s.rank(queries[i]);
+    }));
+    record(structure, distribution, n, "nth_element", rankOps, timeIt([&] {
+        for(size_t i = 0; i < rankOps; ++i) sum += size_t(s.nth(positions[i]));
+    }));
+    record(structure, distribution, n, "traversal", m, timeIt([&] {
+        s.visit([&](int k) { sum += size_t(k); });
+    }));
+
+    Suite copy;
+    record(structure, distribution, n, "copy", m, timeIt([&] { copy = s; }));
+    size_t eraseOps = Suite::linearErase ? linearOps : fastOps;
+    size_t erased = 0;
+    record(structure, distribution, n, "deleteElement", eraseOps, timeIt([&] {
+        for(size_t i = 0; i < eraseOps; ++i) erased += copy.erase(queries[i]);
+    }));
+    size_t minOps = std::min(eraseOps, copy.size());
+    if(minOps != 0)
+        record(structure, distribution, n, "deleteMin", minOps, timeIt([&] {
+            for(size_t i = 0; i < minOps; ++i) copy.deleteMin();
+        }));
+    if(Suite::balances)
+        record(structure, distribution, n, "balance", m, timeIt([&] { s.balance(); }));
+
+    if(found != fastOps || erased == 0 || sum == 0)
+        throw logic_error("résultat inattendu");
+}
+
+//
+// @brief Suite complète: BinarySearchTree sans équilibrage et avec
+//        AutoBalancing, std::set et vecteur trié, pour chaque ordre des
+//        clés et des tailles 10^3, 10^4, ... jusqu'à n
+//
+// Les mesures sont aussi écrites en JSON sur la sortie standard.
+//
+// Sans équilibrage, les clés triées ou en séquences donnent un arbre de
+// hauteur O(n): ces cas sont omis au-delà de degenerateMax clés.
+//
+void suite(size_t n) {
+    const size_t degenerateMax = 20000;
+    for(size_t size = 1000; size <= n; size *= 10) {
+        for(const char* distribution : distributions) {
+            vector<int> keys = keysFor(distribution, size, 27);
+            bool degenerate = string(distribution) == "sorted" || string(distribution) == "reverse"
+                              || string(distribution) == "clustered";
+            if(!degenerate || size <= degenerateMax)
+                measureSuite<TreeSuite<BinarySearchTree<int>>>("abr", distribution, keys);
+            measureSuite<TreeSuite<BinarySearchTree<int, less<int>, NewDeleteAllocator, AutoBalancing<>>>>(
+                    "abr-auto", distribution, keys);
+            measureSuite<SetSuite>("std::set", distribution, keys);
+            measureSuite<VectorSuite>("vector", distribution, keys);
+        }
+    }
+    closeRecords();
+}
+
+const map<string, pair<function<void(size_t)>, size_t>> benchmarks = {
+    { "hotpaths", { hotPaths, 20000 } },
+    { "batch", { batch, 1000000 } },
+    { "splitjoin", { splitJoin, 1000000 } },
+    { "setops", { setOps, 1000000 } },
+    { "parbalance", { parallelBalance, 10000000 } },
+    { "parcopy", { parallelCopy, 10000000 } },
+    { "deferred", { deferred, 1000000 } },
+    { "persistent", { persistent, 1000000 } },
+    { "moves", { moves, 1000000 } },
+    { "transparent", { transparent, 1000000 } },
+    { "comparisons", { comparisons, 1000000 } },
+    { "trace", { trace, 1000000 } },
+    { "stats", { stats, 1000000 } },
+    { "autobalance", { autoBalance, 20000 } },
+    { "suite", { suite, 100000 } },
+    { "lockfree", { lockFree, 2000000 } },
+    { "synchronized", { synchronized, 2000000 } },
+    { "sharded", { sharded, 2000000 } },
+};
+
+} // namespace
+
+int main(int argc, char* argv[]) {
+    if(argc < 2 || benchmarks.count(argv[1]) == 0) {
+        cerr << "usage: " << argv[0] << " <mesure> [n]\nmesures:";
+        for(auto& b : benchmarks)
+            cerr << " " << b.first;
+        cerr << endl;
+        return 1;
+    }
+
+    auto& b = benchmarks.at(argv[1]);
+    size_t n = argc > 2 ? stoul(argv[2]) : b.second;
+    b.first(n);
+    return 0;
+}
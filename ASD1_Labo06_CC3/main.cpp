@@ -2,7 +2,19 @@
 
 #include <iostream>
 #include <algorithm>
+#include <cmath>
+#include <iterator>
+#include <numeric>
+#include <set>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
 #include "abr.cpp"
+#include "abr_persistent.cpp"
+#include "abr_lockfree.cpp"
+#include "abr_synchronized.cpp"
+#include "abr_sharded.cpp"
 using namespace std;
 
 
@@ -52,13 +64,520 @@ int Int::timeBomb = 0;
 
 void visitor(const Int& a) { cout << a << " "; }
 
+// Vérifie que l'arbre contient exactement les clés attendues, dans l'ordre,
+// et que les nbElements sont cohérents: rank(nth_element(i)) == i
+template < typename Tree >
+bool verifier(const Tree& abr, const vector<int>& attendu) {
+  if(abr.size() != attendu.size())
+    return false;
+  if(!equal(abr.begin(), abr.end(), attendu.begin(), attendu.end()))
+    return false;
+  for(size_t i = 0; i < attendu.size(); ++i)
+    if(abr.nth_element(i) != attendu[i] || abr.rank(attendu[i]) != i)
+      return false;
+  return true;
+}
+
+void resultat(const string& test, bool ok) {
+  cout << test << ": " << (ok ? "OK" : "ERREUR") << "\n";
+}
+
+using ScapegoatTree = BinarySearchTree<int, less<int>, NewDeleteAllocator, ScapegoatBalancing<>>;
+
+struct TagSplitJoin {};
+
+//
+// Split suivis de join sur un arbre scapegoat des clés 0 à n - 1. Les
+// noeuds sont réutilisés, sans création ni destruction, et chaque paire
+// ne touche en moyenne que O(hauteur) noeuds: chemins parcourus, noeuds
+// déplacés par les rotations et reconstruits. Une reconstruction à chaque
+// join en toucherait O(n). Les durées sont mesurées par bench.cpp.
+//
+void testerSplitJoinScapegoat() {
+  using Stats = OperationStats<TagSplitJoin>;
+  using Tree = BinarySearchTree<int, less<int>, NewDeleteAllocator, ScapegoatBalancing<>, NoTrace, Stats>;
+  const size_t n = 200000;
+  Tree abr;
+  vector<int> cles(n);
+  for(size_t i = 0; i < n; ++i) {
+    cles[i] = int(i);
+    abr.insert(int(i * 7919 % n));
+  }
+  Stats::reset();
+  const size_t repetitions = 1000;
+  for(size_t i = 0; i < repetitions; ++i) {
+    auto parties = abr.split(int(i * 104729 % n));
+    abr = Tree::join(move(parties.first), move(parties.second));
+  }
+  auto s = Stats::snapshot();
+  size_t touches = s[TreeOperation::split].visited + s[TreeOperation::join].visited;
+  resultat("contenu", verifier(abr, cles));
+  resultat("noeuds réutilisés", s.allocated == 0 && s.freed == 0 && s[TreeOperation::split].calls == repetitions);
+  resultat("noeuds touchés en O(hauteur)", touches <= repetitions * 8 * abr.height());
+}
+
+struct TagUnion {};
+
+//
+// Union d'un arbre scapegoat des clés paires de 0 à 2n - 2 avec 100 clés
+// impaires: les noeuds des deux arbres sont réutilisés, sans création ni
+// destruction. Les durées sont mesurées par bench.cpp.
+//
+void testerUnionScapegoat() {
+  using Stats = OperationStats<TagUnion>;
+  using Tree = BinarySearchTree<int, less<int>, NewDeleteAllocator, ScapegoatBalancing<>, NoTrace, Stats>;
+  const size_t n = 200000;
+  Tree grand;
+  Tree petit;
+  vector<int> cles;
+  for(size_t i = 0; i < n; ++i)
+    grand.insert(int(2 * (i * 7919 % n)));
+  for(size_t i = 0; i < n; ++i) {
+    cles.push_back(int(2 * i));
+    if(i % (n / 100) == 0) {
+      petit.insert(int(2 * i + 1));
+      cles.push_back(int(2 * i + 1));
+    }
+  }
+  Stats::reset();
+  Tree reunion = Tree::set_union(move(grand), move(petit));
+  auto s = Stats::snapshot();
+  resultat("contenu", verifier(reunion, cles));
+  resultat("noeuds réutilisés", s.allocated == 0 && s.freed == 0);
+}
+
+// Clés de la référence, dans l'ordre
+vector<int> cles(const set<int>& reference) {
+  return vector<int>(reference.begin(), reference.end());
+}
+
+// Les clés 0 à n - 1 dans un ordre mélangé mais reproductible
+vector<int> melange(size_t n) {
+  vector<int> v(n);
+  for(size_t i = 0; i < n; ++i)
+    v[i] = int(i * 7919 % n);
+  return v;
+}
+
+//
+// Insertions et suppressions mélangées, qui réutilisent les noeuds libérés
+// du pool
+//
+void testerAllocateur() {
+  const size_t n = 2000;
+  BinarySearchTree<int, less<int>, PoolAllocator> abr;
+  set<int> reference;
+  for(int k : melange(n)) {
+    abr.insert(k);
+    reference.insert(k);
+  }
+  for(int k = 0; k < int(n); k += 2) {
+    abr.deleteElement(k);
+    reference.erase(k);
+  }
+  for(int k = 0; k < int(n); k += 4) {
+    abr.insert(k);
+    reference.insert(k);
+  }
+  resultat("PoolAllocator", verifier(abr, cles(reference)));
+}
+
+// Borne de hauteur d'un arbre équilibré de n noeuds, valable pour AVL
+// (1.44 log2(n)), scapegoat 2/3 (1.71 log2(n)) et AutoBalancing (2 log2(n))
+bool hauteurLogarithmique(size_t hauteur, size_t n) {
+  return double(hauteur) <= 2 * (log2(double(n)) + 1);
+}
+
+//
+// Insertions triées, qui dégénèrent en liste sans politique, puis
+// suppressions. Le contenu et la hauteur sont vérifiés à chaque étape.
+//
+template < typename Tree >
+void testerPolitique(const string& nom) {
+  const int n = 1000;
+  Tree abr;
+  set<int> reference;
+  for(int i = 0; i < n; ++i) {
+    abr.insert(i);
+    reference.insert(i);
+  }
+  resultat(nom + ", insertions triées", verifier(abr, cles(reference)));
+  resultat(nom + ", hauteur", hauteurLogarithmique(abr.height(), abr.size()));
+  for(int i = 0; i < n; i += 3) {
+    abr.deleteElement(i);
+    reference.erase(i);
+  }
+  for(int i = 0; i < 10; ++i) {
+    abr.deleteMin();
+    reference.erase(reference.begin());
+  }
+  resultat(nom + ", suppressions", verifier(abr, cles(reference)) && !abr.deleteElement(0));
+  resultat(nom + ", hauteur", hauteurLogarithmique(abr.height(), abr.size()));
+}
+
+// Remplit abr et sa référence des multiples de 3 de 0 à 3 (n - 1), dans
+// un ordre mélangé
+void remplir(BinarySearchTree<int>& abr, set<int>& reference, size_t n) {
+  for(int k : melange(n)) {
+    abr.insert(3 * k);
+    reference.insert(3 * k);
+  }
+}
+
+void testerIterateurs() {
+  BinarySearchTree<int> abr;
+  set<int> reference;
+  remplir(abr, reference, 2000);
+  resultat("itérateurs", equal(abr.begin(), abr.end(), reference.begin(), reference.end())
+                         && equal(abr.rbegin(), abr.rend(), reference.rbegin(), reference.rend()));
+}
+
+// Chaque clé de -2 à 3 n + 1, présente ou non, comparée à std::set
+void testerBornes() {
+  const size_t n = 2000;
+  BinarySearchTree<int> abr;
+  set<int> reference;
+  remplir(abr, reference, n);
+  bool ok = true;
+  for(int k = -2; k < int(3 * n) + 2; ++k) {
+    auto lower = reference.lower_bound(k);
+    auto upper = reference.upper_bound(k);
+    auto bas = abr.lower_bound(k);
+    auto haut = abr.upper_bound(k);
+    auto plancher = abr.floor(k);
+    ok = ok && (lower == reference.end() ? bas == abr.end() : bas != abr.end() && *bas == *lower)
+            && (upper == reference.end() ? haut == abr.end() : haut != abr.end() && *haut == *upper)
+            && abr.ceiling(k) == bas
+            && (upper == reference.begin() ? plancher == abr.end()
+                                           : plancher != abr.end() && *plancher == *prev(upper))
+            && abr.insertionRank(k) == size_t(distance(reference.begin(), lower));
+  }
+  resultat("lower_bound, upper_bound, floor, ceiling, insertionRank", ok);
+}
+
+// Intervalles [lo, hi) de 301 clés, décalés de 97
+void testerIntervalles() {
+  const size_t n = 2000;
+  BinarySearchTree<int> abr;
+  set<int> reference;
+  remplir(abr, reference, n);
+  bool ok = true;
+  for(int lo = -5; lo < int(3 * n); lo += 97) {
+    int hi = lo + 301;
+    vector<int> visites;
+    abr.visit_range(lo, hi, [&visites](int k) { visites.push_back(k); });
+    vector<int> attendu(reference.lower_bound(lo), reference.lower_bound(hi));
+    ok = ok && visites == attendu && abr.count_range(lo, hi) == attendu.size();
+  }
+  resultat("count_range, visit_range", ok);
+}
+
+// Construction et assign à partir de clés triées: contenu et hauteur
+// minimale
+void testerConstructionTriee() {
+  const size_t n = 2000;
+  vector<int> triees(n);
+  for(size_t i = 0; i < n; ++i)
+    triees[i] = int(3 * i);
+  BinarySearchTree<int> construit(triees.begin(), triees.end());
+  BinarySearchTree<int> remplace;
+  remplace.insert(-1);
+  remplace.assign(triees.begin(), triees.end());
+  resultat("construction triée", verifier(construit, triees) && verifier(remplace, triees)
+                                 && construit.height() <= size_t(log2(double(n))) + 1);
+}
+
+// Un lot de clés en partie présentes, terminé par un doublon, inséré dans
+// chaque mode
+void testerInsertionParLots() {
+  const size_t n = 2000;
+  BinarySearchTree<int> abr;
+  set<int> reference;
+  remplir(abr, reference, n);
+  using BatchMode = BinarySearchTree<int>::BatchMode;
+  for(auto mode : { make_pair(BatchMode::PerKey, "PerKey"), make_pair(BatchMode::Merge, "Merge"),
+                    make_pair(BatchMode::Auto, "Auto") }) {
+    BinarySearchTree<int> lot(abr);
+    set<int> attendu = reference;
+    vector<int> nouvelles;
+    for(int k = 0; k < int(3 * n); k += 5)
+      nouvelles.push_back(k);
+    nouvelles.push_back(5);
+    lot.insert_batch(nouvelles.begin(), nouvelles.end(), mode.first);
+    attendu.insert(nouvelles.begin(), nouvelles.end());
+    resultat(string("insert_batch ") + mode.second, verifier(lot, cles(attendu)));
+  }
+}
+
+// split, join dans les deux ordres, dont un refusé, puis split_at
+void testerSplitJoin() {
+  BinarySearchTree<int> abr;
+  set<int> reference;
+  remplir(abr, reference, 2000);
+  auto parties = abr.split(1501);
+  set<int> bas(reference.begin(), reference.lower_bound(1501));
+  set<int> haut(reference.lower_bound(1501), reference.end());
+  bool ok = abr.size() == 0 && verifier(parties.first, cles(bas)) && verifier(parties.second, cles(haut));
+
+  bool refuse = false;
+  try {
+    BinarySearchTree<int>::join(move(parties.second), move(parties.first));
+  } catch(const logic_error&) {
+    refuse = true;
+  }
+  BinarySearchTree<int> reuni = BinarySearchTree<int>::join(move(parties.first), move(parties.second));
+  ok = ok && refuse && verifier(reuni, cles(reference));
+
+  auto rangs = reuni.split_at(100);
+  ok = ok && rangs.first.size() == 100 && rangs.second.size() == reference.size() - 100
+          && rangs.second.min() == *next(reference.begin(), 100);
+  resultat("split, split_at, join", ok);
+}
+
+// Multiples de 3 et multiples de 2, comparés aux algorithmes de la STL
+void testerOperationsEnsemblistes() {
+  const size_t n = 2000;
+  BinarySearchTree<int> abr;
+  set<int> reference;
+  remplir(abr, reference, n);
+  BinarySearchTree<int> autre;
+  set<int> autreReference;
+  for(int k : melange(n)) {
+    autre.insert(2 * k);
+    autreReference.insert(2 * k);
+  }
+  vector<int> reunion, intersection, difference;
+  set_union(reference.begin(), reference.end(), autreReference.begin(), autreReference.end(),
+            back_inserter(reunion));
+  set_intersection(reference.begin(), reference.end(), autreReference.begin(), autreReference.end(),
+                   back_inserter(intersection));
+  set_difference(reference.begin(), reference.end(), autreReference.begin(), autreReference.end(),
+                 back_inserter(difference));
+  resultat("set_union", verifier(BinarySearchTree<int>::set_union(abr, autre), reunion));
+  resultat("set_intersection", verifier(BinarySearchTree<int>::set_intersection(abr, autre), intersection));
+  resultat("set_difference", verifier(BinarySearchTree<int>::set_difference(abr, autre), difference));
+}
+
+// Rééquilibrage parallèle d'un arbre linéarisé
+void testerBalanceParallele() {
+  const size_t n = 2000;
+  BinarySearchTree<int> abr;
+  set<int> reference;
+  remplir(abr, reference, n);
+  TaskPool pool(4);
+  abr.linearize();
+  abr.balance(pool);
+  resultat("balance parallèle", verifier(abr, cles(reference)) && abr.height() <= size_t(log2(double(n))) + 1);
+}
+
+// Copie et destruction parallèles
+void testerCopieEtClearParalleles() {
+  BinarySearchTree<int> abr;
+  set<int> reference;
+  remplir(abr, reference, 2000);
+  TaskPool pool(4);
+  BinarySearchTree<int> copie(abr, pool);
+  bool ok = verifier(copie, cles(reference)) && verifier(abr, cles(reference));
+  copie.clear(pool);
+  resultat("copie et clear parallèles", ok && copie.size() == 0);
+}
+
+// Les noeuds remplacés par une affectation et ceux de l'arbre détruit
+// passent par le Reclaimer
+void testerDestructionDifferee() {
+  const size_t n = 2000;
+  Reclaimer reclaimer;
+  {
+    BinarySearchTree<int> abr;
+    abr.set_reclaimer(&reclaimer);
+    for(int k : melange(n))
+      abr.insert(k);
+    BinarySearchTree<int> copie(abr);
+    abr = move(copie);
+    vector<int> attendu(n);
+    iota(attendu.begin(), attendu.end(), 0);
+    resultat("set_reclaimer, contenu", verifier(abr, attendu));
+  }
+  reclaimer.flush();
+  resultat("set_reclaimer, destruction", reclaimer.pending() == 0 && reclaimer.reclaimedBytes() > 0);
+}
+
+// Une version modifiée ne change pas la version copiée avant
+void testerPersistant() {
+  PersistentBinarySearchTree<int> version;
+  for(int k : melange(100))
+    version.insert(k);
+  PersistentBinarySearchTree<int> ancienne = version;
+  version.deleteElement(50);
+  version.insert(200);
+  version.deleteMin();
+  bool ok = ancienne.size() == 100 && ancienne.contains(50) && !ancienne.contains(200)
+            && ancienne.min() == 0 && ancienne.nth_element(50) == 50 && ancienne.rank(99) == 99;
+  ok = ok && version.size() == 99 && !version.contains(50) && version.contains(200)
+          && version.min() == 1 && version.rank(200) == 98;
+  resultat("PersistentBinarySearchTree", ok);
+}
+
+const int threads = 4;
+const int parThread = 2000;
+
+//
+// Chaque thread insère ses propres clés, puis en supprime une sur deux,
+// pendant que les autres font de meme
+//
+template < typename Tree >
+void insererEnParallele(Tree& abr) {
+  vector<thread> travailleurs;
+  for(int t = 0; t < threads; ++t)
+    travailleurs.emplace_back([&abr, t] {
+      for(int i = 0; i < parThread; ++i)
+        abr.insert(i * threads + t);
+      for(int i = 0; i < parThread; i += 2)
+        abr.deleteElement(i * threads + t);
+    });
+  for(thread& t : travailleurs)
+    t.join();
+}
+
+// Les clés laissées par insererEnParallele, dans l'ordre
+vector<int> clesEnParallele() {
+  vector<int> attendu;
+  for(int i = 1; i < parThread; i += 2)
+    for(int t = 0; t < threads; ++t)
+      attendu.push_back(i * threads + t);
+  return attendu;
+}
+
+void testerSansVerrou() {
+  LockFreeBinarySearchTree<int> abr;
+  insererEnParallele(abr);
+  vector<int> attendu = clesEnParallele();
+  bool ok = abr.min() == attendu.front();
+  for(int k = 0; k < threads * parThread; ++k)
+    ok = ok && abr.contains(k) == binary_search(attendu.begin(), attendu.end(), k);
+  resultat("LockFreeBinarySearchTree", ok && !abr.insert(attendu.back()) && abr.deleteElement(attendu.back()));
+}
+
+void testerSynchronise() {
+  SynchronizedBinarySearchTree<int> abr;
+  insererEnParallele(abr);
+  vector<int> attendu = clesEnParallele();
+  bool ok = abr.read([&attendu](const BinarySearchTree<int>& t) { return verifier(t, attendu); });
+  ok = ok && abr.size() == attendu.size() && abr.min() == attendu.front()
+          && abr.nth_element(10) == attendu[10] && abr.rank(attendu[10]) == 10;
+  ok = ok && abr.extractMin() == attendu.front() && abr.size() == attendu.size() - 1;
+  resultat("SynchronizedBinarySearchTree", ok);
+}
+
+void testerPartitionne() {
+  ShardedBinarySearchTree<int> abr(threads);
+  insererEnParallele(abr);
+  vector<int> attendu = clesEnParallele();
+  vector<int> visites;
+  abr.visitSym([&visites](int k) { visites.push_back(k); });
+  size_t total = 0;
+  for(size_t s : abr.shard_sizes())
+    total += s;
+  bool ok = visites == attendu && abr.size() == attendu.size() && total == attendu.size()
+            && abr.min() == attendu.front();
+  for(size_t i = 0; i < attendu.size(); i += 97)
+    ok = ok && abr.nth_element(i) == attendu[i] && abr.rank(attendu[i]) == i;
+  resultat("ShardedBinarySearchTree", ok);
+}
+
+// La copie de la deuxième borne échoue pendant la répartition: aucune clé
+// ne doit etre perdue
+void testerRepartitionManquee() {
+  ShardedBinarySearchTree<Int> abr(threads);
+  Int::timeBomb = 1;
+  for(int k : melange(1000))
+    abr.insert(k);
+  bool refuse = false;
+  try {
+    Int::timeBomb = -2;
+    abr.rebalance();
+  } catch(const logic_error&) {
+    refuse = true;
+  }
+  bool ok = refuse && abr.size() == 1000 && abr.shard_sizes()[0] == 1000;
+  for(int k = 0; k < 1000; ++k)
+    ok = ok && abr.contains(k) && abr.rank(k) == size_t(k);
+  abr.rebalance();
+  resultat("ShardedBinarySearchTree, exception pendant rebalance", ok && abr.shard_sizes()[1] == 250);
+}
+
+// Une clé déplacée n'est vidée que si elle est insérée
+void testerEmplace() {
+  BinarySearchTree<string> mots;
+  string mot = "arbre";
+  mots.insert(move(mot));
+  string doublon = "arbre";
+  mots.insert(move(doublon));
+  bool ok = doublon == "arbre" && mots.emplace(5, 'x') && !mots.emplace("arbre") && mots.emplace("binaire");
+  ok = ok && mots.size() == 3 && mots.nth_element(0) == "arbre" && mots.nth_element(2) == "xxxxx";
+  resultat("insert(T&&), emplace", ok);
+}
+
+// Ordre décroissant, et recherches par string_view sans construire de
+// string
+void testerComparaison() {
+  BinarySearchTree<int, greater<int>> decroissant;
+  for(int k : melange(100))
+    decroissant.insert(k);
+  bool ok = decroissant.min() == 99 && decroissant.nth_element(99) == 0 && decroissant.rank(90) == 9;
+
+  BinarySearchTree<string, less<>> mots;
+  for(const char* m : { "pomme", "poire", "prune" })
+    mots.insert(m);
+  string_view cle = "poire";
+  ok = ok && mots.contains(cle) && !mots.contains(string_view("peche")) && mots.rank(cle) == 0
+          && mots.count_range(string_view("p"), string_view("q")) == 3;
+  resultat("Compare, recherches transparentes", ok);
+}
+
+struct TagTrace {};
+
+// Créations et destructions comptées, y compris celles du destructeur
+void testerTrace() {
+  using Trace = CountingTrace<TagTrace>;
+  {
+    BinarySearchTree<int, less<int>, NewDeleteAllocator, NoBalancing, Trace> abr;
+    for(int k : melange(100))
+      abr.insert(k);
+    abr.deleteElement(5);
+    abr.deleteMin();
+    resultat("CountingTrace, créations", Trace::created() == 100 && Trace::live() == abr.size());
+  }
+  resultat("CountingTrace, destructions", Trace::live() == 0 && Trace::destroyed() == 100);
+}
+
+struct TagStats {};
+
+// Arbre parfait de hauteur 3: la recherche de 7 compare 3 clés
+void testerStatistiques() {
+  using Stats = OperationStats<TagStats>;
+  {
+    BinarySearchTree<int, less<int>, NewDeleteAllocator, NoBalancing, NoTrace, Stats> abr;
+    for(int k : { 4, 2, 6, 1, 3, 5, 7 })
+      abr.insert(k);
+    abr.contains(7);
+    abr.deleteElement(1);
+    auto s = Stats::snapshot();
+    resultat("OperationStats, opérations",
+             s[TreeOperation::insert].calls == 7 && s[TreeOperation::contains].calls == 1
+             && s[TreeOperation::contains].compared == 3 && s.longestPath == 3 && abr.height() == 3);
+  }
+  auto s = Stats::snapshot();
+  resultat("OperationStats, allocations", s.allocated == 7 && s.freed == 7);
+}
+
 int main() {
   
   try {
     
     vector<int> values = { 10, 12, 16, 15, 7, 1, 12, 5, 11, 11, 4, 2, 6, 0, 13 };
     
-    BinarySearchTree<Int> abr;
+    TracedBinarySearchTree<Int> abr;
     
     // **** INSERT ****
     
@@ -154,7 +673,7 @@ int main() {
     
     cout << "Test du move constructor - abr2(move(abr)) \n";
     {
-      BinarySearchTree<Int> abr2 ( move(abr) );
+      TracedBinarySearchTree<Int> abr2 ( move(abr) );
       cout << "abr2: "; abr2.display();
       cout << "\n";
       cout << "abr: "; abr.display();
@@ -162,14 +681,14 @@ int main() {
       
       {
         cout << "Test du copy constructor - abr3(abr2)\n";
-        BinarySearchTree<Int> abr3 ( abr2 );
+        TracedBinarySearchTree<Int> abr3 ( abr2 );
         cout << "\n";
         cout << "abr3: "; abr3.display();
         cout << "\n";
         
         {
           cout << "Test du move operator= - abr4 = move(abr2)\n";
-          BinarySearchTree<Int> abr4;
+          TracedBinarySearchTree<Int> abr4;
           abr4 = move(abr2);
           cout << "abr4: "; abr4.display();
           cout << "\n";
@@ -224,7 +743,7 @@ int main() {
     try {
       Int::timeBomb = -9;
       cout << "Test de copie par constructeur manquee \n";
-      BinarySearchTree<Int> abr2(abr);
+      TracedBinarySearchTree<Int> abr2(abr);
     } catch (...) {
       cout << "\nException capturée \n\n";
     }
@@ -232,7 +751,7 @@ int main() {
     
     {
       cout << "Creation abr2 \n";
-      BinarySearchTree<Int> abr2;
+      TracedBinarySearchTree<Int> abr2;
       for(int i : { 3, 7, 4, 1, 2 } )
         abr2.insert(i);
       
@@ -282,5 +801,50 @@ int main() {
   } catch (...) {
     cout << "\nErreur - une exception imprévue a été capturée \n";
   }
+
+  // **** SPLIT ET JOIN REPETES AVEC SCAPEGOAT ****
+
+  cout << "\nTest de split et join répétés sur un arbre scapegoat \n";
+  testerSplitJoinScapegoat();
+
+  // **** OPERATIONS ENSEMBLISTES AVEC SCAPEGOAT ****
+
+  cout << "\nTest de set_union avec 100 clés sur un arbre scapegoat \n";
+  testerUnionScapegoat();
+
+  // **** OPERATIONS AJOUTEES A L'ARBRE ****
+
+  cout << "\nTest des opérations ajoutées \n";
+  testerAllocateur();
+  testerIterateurs();
+  testerBornes();
+  testerIntervalles();
+  testerConstructionTriee();
+  testerInsertionParLots();
+  testerSplitJoin();
+  testerOperationsEnsemblistes();
+  testerBalanceParallele();
+  testerCopieEtClearParalleles();
+  testerDestructionDifferee();
+  testerEmplace();
+  testerComparaison();
+  testerTrace();
+  testerStatistiques();
+
+  // **** POLITIQUES D'EQUILIBRAGE ****
+
+  cout << "\nTest des politiques d'équilibrage \n";
+  testerPolitique<BinarySearchTree<int, less<int>, NewDeleteAllocator, AVLBalancing>>("AVL");
+  testerPolitique<ScapegoatTree>("scapegoat");
+  testerPolitique<BinarySearchTree<int, less<int>, NewDeleteAllocator, AutoBalancing<>>>("AutoBalancing");
+
+  // **** ARBRES PERSISTANTS ET PARTAGES ENTRE THREADS ****
+
+  cout << "\nTest des arbres persistants et partagés entre threads \n";
+  testerPersistant();
+  testerSansVerrou();
+  testerSynchronise();
+  testerPartitionne();
+  testerRepartitionManquee();
   return 0;
 }
@@ -0,0 +1,162 @@
+//
+//  Destruction différée sur un thread séparé
+//
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <new>
+#include <thread>
+#include <utility>
+#include <vector>
+
+using namespace std;
+
+//
+// @brief Détruit des objets sur un thread d'arrière plan
+//
+// dispose confie un objet, par exemple un arbre détaché, au thread qui le
+// détruira plus tard. L'appelant ne paie que le déplacement de l'objet. La
+// file est bornée: quand elle est pleine, l'objet est détruit tout de suite
+// par l'appelant, ce qui borne la mémoire en attente de libération.
+//
+// Le Reclaimer doit survivre aux objets qui l'utilisent. Son destructeur
+// attend la destruction de tous les objets confiés.
+//
+class Reclaimer {
+    struct Garbage {
+        size_t bytes;
+
+        explicit Garbage(size_t bytes) : bytes(bytes) {
+        }
+
+        virtual ~Garbage() = default;
+    };
+
+    template < typename T >
+    struct GarbageFor final : Garbage {
+        T object;
+
+        GarbageFor(T&& object, size_t bytes) : Garbage(bytes), object(std::move(object)) {
+        }
+    };
+
+    vector<Garbage*> ring; // file circulaire de capacité fixe
+    size_t head = 0;       // plus ancien objet en attente
+    size_t count = 0;      // nombre d'objets en attente
+    mutex lock;
+    condition_variable wakeUp; // signale un objet à détruire ou l'arret
+    condition_variable idle;   // signale une file vide et rien en cours
+    bool busy = false;         // un objet est en cours de destruction
+    bool stopping = false;
+    atomic<size_t> pendingCount{ 0 };
+    atomic<size_t> pendingTotal{ 0 };
+    atomic<size_t> reclaimedTotal{ 0 };
+    thread worker;
+
+public:
+    //
+    // @brief Démarre le thread de destruction
+    //
+    // @param capacity le nombre maximum d'objets en attente
+    //
+    explicit Reclaimer(size_t capacity = 64) : ring(std::max<size_t>(capacity, 1)) {
+        worker = thread([this] { work(); });
+    }
+
+    Reclaimer(const Reclaimer&) = delete;
+    Reclaimer& operator = (const Reclaimer&) = delete;
+
+    ~Reclaimer() {
+        {
+            lock_guard<mutex> guard(lock);
+            stopping = true;
+        }
+        wakeUp.notify_one();
+        worker.join();
+    }
+
+    //
+    // @brief Confie object au thread de destruction
+    //
+    // @param object l'objet, déplacé s'il est accepté
+    // @param bytes la mémoire qu'il libérera, pour les compteurs
+    //
+    // Si la file est pleine, object est détruit immédiatement. Si la place
+    // pour le confier manque, il est laissé intact à l'appelant.
+    //
+    //  Complexité: O(1) si l'objet est accepté
+    //
+    template < typename T >
+    void dispose(T&& object, size_t bytes) noexcept {
+        static_assert(!is_lvalue_reference<T>::value, "object doit etre une rvalue");
+        static_assert(is_nothrow_move_constructible<T>::value, "T doit etre déplaçable sans exception");
+        Garbage* garbage = new (nothrow) GarbageFor<T>(std::move(object), bytes);
+        if(garbage == nullptr)
+            return;
+
+        unique_lock<mutex> guard(lock);
+        if(count == ring.size()) {
+            guard.unlock();
+            delete garbage;
+            reclaimedTotal.fetch_add(bytes);
+            return;
+        }
+        ring[(head + count++) % ring.size()] = garbage;
+        pendingCount.fetch_add(1);
+        pendingTotal.fetch_add(bytes);
+        guard.unlock();
+        wakeUp.notify_one();
+    }
+
+    //
+    // @brief Attend la destruction de tous les objets confiés jusqu'ici
+    //
+    void flush() {
+        unique_lock<mutex> guard(lock);
+        idle.wait(guard, [this] { return count == 0 && !busy; });
+    }
+
+    // nombre d'objets en attente de destruction
+    size_t pending() const noexcept {
+        return pendingCount.load();
+    }
+
+    // mémoire en attente de libération, en octets
+    size_t pendingBytes() const noexcept {
+        return pendingTotal.load();
+    }
+
+    // mémoire libérée depuis la création, en octets, y compris celle des
+    // objets détruits par dispose quand la file était pleine
+    size_t reclaimedBytes() const noexcept {
+        return reclaimedTotal.load();
+    }
+
+private:
+    void work() noexcept {
+        unique_lock<mutex> guard(lock);
+        for(;;) {
+            wakeUp.wait(guard, [this] { return stopping || count != 0; });
+            if(count == 0)
+                return;
+            Garbage* garbage = ring[head];
+            head = (head + 1) % ring.size();
+            --count;
+            busy = true;
+            guard.unlock();
+
+            size_t bytes = garbage->bytes;
+            delete garbage;
+            pendingCount.fetch_sub(1);
+            pendingTotal.fetch_sub(bytes);
+            reclaimedTotal.fetch_add(bytes);
+
+            guard.lock();
+            busy = false;
+            if(count == 0)
+                idle.notify_all();
+        }
+    }
+};
@@ -0,0 +1,238 @@
+//
+//  Politiques de statistiques des opérations de l'arbre
+//
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+
+using namespace std;
+
+//
+// Une politique de statistiques fournit:
+//   - Path, le compteur local d'une opération: visit(count) pour chaque
+//     noeud visité, ou pour count noeuds reconstruits d'un coup,
+//     compare() pour chaque noeud dont la clé est comparée;
+//   - record(op, path), appelée à la fin de l'opération;
+//   - allocated(), appelée pour chaque noeud créé, et freed(count) pour
+//     chaque noeud détruit, ou une seule fois pour tous les noeuds rendus
+//     en bloc à l'allocateur;
+//   - Timer, startTimer() et balanced(timer) autour de chaque balance().
+//
+// Les fonctions sont statiques, ne lèvent pas d'exception et peuvent etre
+// appelées par plusieurs threads à la fois.
+//
+
+//
+// split et join comptent les noeuds du chemin parcouru et ceux déplacés
+// par les rotations ou reconstruits pour rééquilibrer le résultat. Ils
+// n'entrent pas dans l'histogramme des longueurs de chemin.
+//
+enum class TreeOperation { insert, contains, deleteElement, rank, nthElement, split, join };
+
+constexpr size_t treeOperationCount = 7;
+
+constexpr bool isSearchPath(TreeOperation op) noexcept {
+    return op != TreeOperation::split && op != TreeOperation::join;
+}
+
+//
+// @brief Politique par défaut: aucune statistique
+//
+// Les compteurs et les appels sont vides et disparaissent à la
+// compilation.
+//
+struct NoStats {
+    static constexpr bool enabled = false;
+
+    struct Path {
+        void visit(size_t = 1) noexcept {
+        }
+        void compare() noexcept {
+        }
+    };
+
+    struct Timer {};
+
+    static void record(TreeOperation, const Path&) noexcept {
+    }
+
+    static void allocated() noexcept {
+    }
+
+    static void freed(size_t = 1) noexcept {
+    }
+
+    static Timer startTimer() noexcept {
+        return {};
+    }
+
+    static void balanced(Timer) noexcept {
+    }
+};
+
+//
+// @brief Compte les opérations, les noeuds visités, les comparaisons, les
+//        allocations et le temps passé dans balance()
+//
+// Les compteurs sont des atomiques relaxés, répartis en bandes d'une ligne
+// de cache selon le thread: des threads différents n'écrivent pas dans la
+// meme ligne. Une opération coute quelques additions atomiques.
+//
+// snapshot() additionne les bandes sans bloquer les opérations: il peut
+// etre appelé souvent, par exemple chaque seconde pour exporter les
+// compteurs. Les compteurs d'un instantané peuvent etre décalés de
+// quelques opérations concurrentes.
+//
+// Les statistiques sont partagées par tous les arbres qui utilisent la
+// meme politique. Tag permet d'en obtenir des indépendantes.
+//
+template < typename Tag = void >
+class OperationStats {
+public:
+    static constexpr bool enabled = true;
+
+    // profondeurs distinguées par l'histogramme. Le dernier intervalle
+    // regroupe les chemins plus longs.
+    static constexpr size_t depthBuckets = 64;
+
+    struct Path {
+        size_t visited = 0;  // noeuds visités
+        size_t compared = 0; // noeuds dont la clé a été comparée
+
+        void visit(size_t count = 1) noexcept {
+            visited += count;
+        }
+        void compare() noexcept {
+            ++visited;
+            ++compared;
+        }
+    };
+
+    using Clock = chrono::steady_clock;
+    using Timer = Clock::time_point;
+
+    struct Counters {
+        size_t calls = 0;
+        size_t visited = 0;
+        size_t compared = 0;
+    };
+
+    struct Snapshot {
+        Counters operations[treeOperationCount];
+        size_t depths[depthBuckets] = {}; // nombre d'opérations par longueur de chemin
+        // plus long chemin parcouru depuis reset(). Il ne diminue pas
+        // après les suppressions ou balance(): la hauteur actuelle d'un
+        // arbre est donnée par sa méthode height().
+        size_t longestPath = 0;
+        size_t allocated = 0;             // noeuds créés
+        size_t freed = 0;                 // noeuds détruits
+        size_t balances = 0;              // appels à balance()
+        size_t balanceNs = 0;             // temps cumulé dans balance()
+
+        const Counters& operator [] (TreeOperation op) const noexcept {
+            return operations[size_t(op)];
+        }
+    };
+
+    static void record(TreeOperation op, const Path& path) noexcept {
+        Stripe& s = ownStripe();
+        OperationCounters& c = s.operations[size_t(op)];
+        c.calls.fetch_add(1, memory_order_relaxed);
+        c.visited.fetch_add(path.visited, memory_order_relaxed);
+        c.compared.fetch_add(path.compared, memory_order_relaxed);
+        if(!isSearchPath(op))
+            return;
+        s.depths[std::min(path.visited, depthBuckets - 1)].fetch_add(1, memory_order_relaxed);
+
+        size_t longest = longestPath.load(memory_order_relaxed);
+        while(path.visited > longest
+              && !longestPath.compare_exchange_weak(longest, path.visited, memory_order_relaxed))
+            ;
+    }
+
+    static void allocated() noexcept {
+        ownStripe().allocated.fetch_add(1, memory_order_relaxed);
+    }
+
+    static void freed(size_t count = 1) noexcept {
+        ownStripe().freed.fetch_add(count, memory_order_relaxed);
+    }
+
+    static Timer startTimer() noexcept {
+        return Clock::now();
+    }
+
+    static void balanced(Timer start) noexcept {
+        size_t ns = size_t(chrono::duration_cast<chrono::nanoseconds>(Clock::now() - start).count());
+        balances.fetch_add(1, memory_order_relaxed);
+        balanceNs.fetch_add(ns, memory_order_relaxed);
+    }
+
+    //
+    //  Complexité: O(stripeCount (treeOperationCount + depthBuckets))
+    //
+    static Snapshot snapshot() noexcept {
+        Snapshot result;
+        for(const Stripe& s : stripes) {
+            for(size_t op = 0; op < treeOperationCount; ++op) {
+                result.operations[op].calls += s.operations[op].calls.load(memory_order_relaxed);
+                result.operations[op].visited += s.operations[op].visited.load(memory_order_relaxed);
+                result.operations[op].compared += s.operations[op].compared.load(memory_order_relaxed);
+            }
+            for(size_t d = 0; d < depthBuckets; ++d)
+                result.depths[d] += s.depths[d].load(memory_order_relaxed);
+            result.allocated += s.allocated.load(memory_order_relaxed);
+            result.freed += s.freed.load(memory_order_relaxed);
+        }
+        result.longestPath = longestPath.load(memory_order_relaxed);
+        result.balances = balances.load(memory_order_relaxed);
+        result.balanceNs = balanceNs.load(memory_order_relaxed);
+        return result;
+    }
+
+    static void reset() noexcept {
+        for(Stripe& s : stripes) {
+            for(OperationCounters& c : s.operations) {
+                c.calls.store(0, memory_order_relaxed);
+                c.visited.store(0, memory_order_relaxed);
+                c.compared.store(0, memory_order_relaxed);
+            }
+            for(atomic<size_t>& d : s.depths)
+                d.store(0, memory_order_relaxed);
+            s.allocated.store(0, memory_order_relaxed);
+            s.freed.store(0, memory_order_relaxed);
+        }
+        longestPath.store(0, memory_order_relaxed);
+        balances.store(0, memory_order_relaxed);
+        balanceNs.store(0, memory_order_relaxed);
+    }
+
+private:
+    struct OperationCounters {
+        atomic<size_t> calls{ 0 };
+        atomic<size_t> visited{ 0 };
+        atomic<size_t> compared{ 0 };
+    };
+
+    struct alignas(64) Stripe {
+        OperationCounters operations[treeOperationCount];
+        atomic<size_t> depths[depthBuckets] = {};
+        atomic<size_t> allocated{ 0 };
+        atomic<size_t> freed{ 0 };
+    };
+
+    static constexpr size_t stripeCount = 16;
+
+    inline static Stripe stripes[stripeCount];
+    inline static atomic<size_t> longestPath{ 0 };
+    inline static atomic<size_t> balances{ 0 };
+    inline static atomic<size_t> balanceNs{ 0 };
+
+    // bande attribuée à chaque thread à sa première opération
+    static Stripe& ownStripe() noexcept {
+        static atomic<size_t> next{ 0 };
+        static thread_local size_t index = next.fetch_add(1, memory_order_relaxed) % stripeCount;
+        return stripes[index];
+    }
+};
@@ -0,0 +1,245 @@
+//
+//  Pool de taches par vol de travail (work stealing)
+//
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+using namespace std;
+
+//
+// @brief Pool de threads exécutant des paires de taches (fork/join)
+//
+// Chaque worker a sa propre file. Il y dépose ses taches et les reprend par
+// la fin (LIFO); un worker inoccupé vole par le début (FIFO) la file d'un
+// autre, où se trouvent les plus grosses taches. Un thread extérieur au pool
+// dépose ses taches dans une file supplémentaire, partagée.
+//
+// Un thread qui attend la fin d'une tache volée exécute d'autres taches en
+// attendant: les invocations imbriquées ne bloquent jamais de worker.
+//
+class TaskPool {
+    struct Job {
+        atomic<bool> done{ false };
+        exception_ptr error;
+
+        virtual void run() noexcept = 0;
+
+    protected:
+        ~Job() = default;
+    };
+
+    template < typename Fn >
+    struct JobFor final : Job {
+        Fn& fn;
+
+        explicit JobFor(Fn& fn) : fn(fn) {
+        }
+
+        void run() noexcept override {
+            try {
+                fn();
+            } catch(...) {
+                this->error = current_exception();
+            }
+            this->done.store(true, memory_order_release);
+        }
+    };
+
+    struct Queue {
+        mutex lock;
+        deque<Job*> jobs;
+    };
+
+    vector<unique_ptr<Queue>> queues; // une par worker, puis la file partagée
+    vector<thread> workers;
+
+    mutex sleepLock;
+    condition_variable wakeUp;
+    atomic<size_t> pending{ 0 };  // taches déposées et pas encore reprises
+    atomic<size_t> sleeping{ 0 }; // workers en attente sur wakeUp
+    bool stopping = false;        // protégé par sleepLock
+
+    static inline thread_local TaskPool* currentPool = nullptr;
+    static inline thread_local size_t currentQueue = 0;
+
+public:
+    //
+    // @brief Construit un pool
+    //
+    // @param concurrency le nombre de threads exécutant les taches, y
+    //        compris le thread appelant invoke. 1 exécute tout en séquence.
+    //
+    explicit TaskPool(size_t concurrency) {
+        size_t n = concurrency > 1 ? concurrency - 1 : 0;
+        for(size_t i = 0; i <= n; ++i)
+            queues.push_back(make_unique<Queue>());
+        try {
+            for(size_t i = 0; i < n; ++i)
+                workers.emplace_back([this, i] { work(i); });
+        } catch(...) {
+            stop();
+            throw;
+        }
+    }
+
+    TaskPool(const TaskPool&) = delete;
+    TaskPool& operator = (const TaskPool&) = delete;
+
+    ~TaskPool() {
+        stop();
+    }
+
+    //
+    // @brief Pool partagé, d'un thread par coeur disponible
+    //
+    // Il n'est jamais détruit: un arbre statique peut encore l'utiliser
+    // dans son destructeur à la fin du programme.
+    //
+    static TaskPool& global() {
+        static TaskPool* pool = new TaskPool(std::max(thread::hardware_concurrency(), 1u));
+        return *pool;
+    }
+
+    size_t concurrency() const noexcept {
+        return workers.size() + 1;
+    }
+
+    //
+    // @brief Exécute f1 et f2, éventuellement en parallèle
+    //
+    // f2 est proposée aux autres threads pendant que le thread appelant
+    // exécute f1. Si personne ne l'a prise entre temps, ou si elle n'a pas
+    // pu etre déposée, elle est exécutée ensuite par le thread appelant.
+    //
+    // @exception la première exception levée par f1, sinon par f2. Les deux
+    //            fonctions sont terminées avant qu'elle ne soit propagée.
+    //
+    template < typename F1, typename F2 >
+    void invoke(F1&& f1, F2&& f2) {
+        JobFor<remove_reference_t<F2>> job(f2);
+        bool queued = !workers.empty();
+        if(queued) {
+            try {
+                push(&job);
+            } catch(...) {
+                queued = false;
+            }
+        }
+
+        exception_ptr error;
+        try {
+            f1();
+        } catch(...) {
+            error = current_exception();
+        }
+
+        if(!queued || retract(&job))
+            job.run();
+        else
+            wait(job);
+
+        if(error)
+            rethrow_exception(error);
+        if(job.error)
+            rethrow_exception(job.error);
+    }
+
+private:
+    size_t ownQueue() const noexcept {
+        return currentPool == this ? currentQueue : queues.size() - 1;
+    }
+
+    void push(Job* job) {
+        Queue& q = *queues[ownQueue()];
+        {
+            lock_guard<mutex> guard(q.lock);
+            q.jobs.push_back(job);
+        }
+        pending.fetch_add(1);
+        if(sleeping.load() != 0) {
+            lock_guard<mutex> guard(sleepLock);
+            wakeUp.notify_one();
+        }
+    }
+
+    //
+    // @brief Reprend job s'il est encore en fin de la file du thread
+    //
+    bool retract(Job* job) noexcept {
+        Queue& q = *queues[ownQueue()];
+        lock_guard<mutex> guard(q.lock);
+        if(q.jobs.empty() || q.jobs.back() != job)
+            return false;
+        q.jobs.pop_back();
+        pending.fetch_sub(1);
+        return true;
+    }
+
+    //
+    // @brief Prend une tache dans la file self, sinon en vole une
+    //
+    Job* take(size_t self) noexcept {
+        for(size_t i = 0; i < queues.size(); ++i) {
+            Queue& q = *queues[(self + i) % queues.size()];
+            lock_guard<mutex> guard(q.lock);
+            if(q.jobs.empty())
+                continue;
+            Job* job;
+            if(i == 0) {
+                job = q.jobs.back();
+                q.jobs.pop_back();
+            } else {
+                job = q.jobs.front();
+                q.jobs.pop_front();
+            }
+            pending.fetch_sub(1);
+            return job;
+        }
+        return nullptr;
+    }
+
+    void wait(Job& job) noexcept {
+        size_t self = ownQueue();
+        while(!job.done.load(memory_order_acquire)) {
+            if(Job* other = take(self))
+                other->run();
+            else
+                this_thread::yield();
+        }
+    }
+
+    void work(size_t self) noexcept {
+        currentPool = this;
+        currentQueue = self;
+        for(;;) {
+            if(Job* job = take(self)) {
+                job->run();
+                continue;
+            }
+            unique_lock<mutex> guard(sleepLock);
+            sleeping.fetch_add(1);
+            wakeUp.wait(guard, [this] { return stopping || pending.load() != 0; });
+            sleeping.fetch_sub(1);
+            if(stopping)
+                return;
+        }
+    }
+
+    void stop() noexcept {
+        {
+            lock_guard<mutex> guard(sleepLock);
+            stopping = true;
+        }
+        wakeUp.notify_all();
+        for(thread& t : workers)
+            t.join();
+        workers.clear();
+    }
+};
@@ -0,0 +1,188 @@
+//
+//  Politiques de traçage des créations et destructions de noeuds
+//
+
+#include <atomic>
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+using namespace std;
+
+//
+// Une politique de traçage fournit:
+//   - onCreate(const Node&), appelée après la construction d'un noeud;
+//   - onDestroy(const Node&), appelée avant sa destruction;
+//   - tracesDestruction, faux si onDestroy n'a aucun effet. L'arbre peut
+//     alors rendre tous ses noeuds en bloc, sans les parcourir.
+//
+// Les fonctions sont statiques et ne doivent pas lever d'exception. Elles
+// peuvent etre appelées par plusieurs threads à la fois si l'allocateur est
+// threadSafe.
+//
+
+//
+// @brief Politique par défaut: aucun traçage, aucun coût
+//
+struct NoTrace {
+    static constexpr bool tracesDestruction = false;
+
+    template < typename Node >
+    static void onCreate(const Node&) noexcept {
+    }
+
+    template < typename Node >
+    static void onDestroy(const Node&) noexcept {
+    }
+};
+
+//
+// @brief Affiche (Ccle) à chaque création et (Dcle) à chaque destruction
+//        sur cout, comme attendu par les tests du laboratoire
+//
+struct CoutTrace {
+    static constexpr bool tracesDestruction = true;
+
+    template < typename Node >
+    static void onCreate(const Node& n) noexcept {
+        cout << "(C" << n.key << ") ";
+    }
+
+    template < typename Node >
+    static void onDestroy(const Node& n) noexcept {
+        cout << "(D" << n.key << ") ";
+    }
+};
+
+//
+// @brief Compte les créations et destructions de noeuds
+//
+// Les compteurs sont partagés par tous les arbres qui utilisent la meme
+// politique. Tag permet d'en obtenir des indépendants.
+//
+template < typename Tag = void >
+class CountingTrace {
+    inline static atomic<size_t> creations{ 0 };
+    inline static atomic<size_t> destructions{ 0 };
+
+public:
+    static constexpr bool tracesDestruction = true;
+
+    template < typename Node >
+    static void onCreate(const Node&) noexcept {
+        creations.fetch_add(1, memory_order_relaxed);
+    }
+
+    template < typename Node >
+    static void onDestroy(const Node&) noexcept {
+        destructions.fetch_add(1, memory_order_relaxed);
+    }
+
+    static size_t created() noexcept {
+        return creations.load(memory_order_relaxed);
+    }
+
+    static size_t destroyed() noexcept {
+        return destructions.load(memory_order_relaxed);
+    }
+
+    // noeuds créés et pas encore détruits
+    static size_t live() noexcept {
+        return created() - destroyed();
+    }
+
+    static void reset() noexcept {
+        creations.store(0, memory_order_relaxed);
+        destructions.store(0, memory_order_relaxed);
+    }
+};
+
+//
+// @brief Journal des Capacity derniers évènements dans un tampon
+//        circulaire sans verrou
+//
+// Un évènement est une création ou une destruction et l'adresse du noeud.
+// Chaque écrivain réserve un numéro par fetch_add puis écrit l'emplacement
+// correspondant: aucun thread n'attend. events() rend les évènements
+// encore présents, du plus ancien au plus récent. Un évènement écrasé
+// pendant sa lecture est omis.
+//
+// Le tampon est partagé par tous les arbres qui utilisent la meme
+// politique. Tag permet d'en obtenir des indépendants.
+//
+template < size_t Capacity = 4096, typename Tag = void >
+class RingBufferTrace {
+    static_assert(Capacity != 0 && (Capacity & (Capacity - 1)) == 0,
+                  "Capacity doit etre une puissance de 2");
+
+public:
+    enum class Kind { create, destroy };
+
+    struct Event {
+        size_t sequence; // numéro de l'évènement depuis le début
+        Kind kind;
+        const void* node;
+    };
+
+    static constexpr bool tracesDestruction = true;
+
+    template < typename Node >
+    static void onCreate(const Node& n) noexcept {
+        record(&n, Kind::create);
+    }
+
+    template < typename Node >
+    static void onDestroy(const Node& n) noexcept {
+        record(&n, Kind::destroy);
+    }
+
+    // nombre d'évènements enregistrés depuis le début
+    static size_t recorded() noexcept {
+        return next.load(memory_order_relaxed);
+    }
+
+    //
+    //  Complexité: O(Capacity)
+    //
+    static vector<Event> events() {
+        vector<Event> result;
+        size_t last = next.load(memory_order_acquire);
+        size_t first = last > Capacity ? last - Capacity : 0;
+        for(size_t seq = first; seq < last; ++seq) {
+            const Slot& s = slots[seq & (Capacity - 1)];
+            if(s.stamp.load(memory_order_acquire) != seq + 1)
+                continue;
+            uintptr_t word = s.word.load(memory_order_relaxed);
+            atomic_thread_fence(memory_order_acquire);
+            if(s.stamp.load(memory_order_relaxed) != seq + 1)
+                continue;
+            result.push_back({ seq, (word & 1) != 0 ? Kind::destroy : Kind::create,
+                               reinterpret_cast<const void*>(word & ~uintptr_t(1)) });
+        }
+        return result;
+    }
+
+private:
+    //
+    // stamp vaut le numéro de l'évènement plus un une fois word écrit, 0
+    // pendant l'écriture. Le bit de poids faible de word, toujours nul
+    // dans l'adresse d'un noeud, code le type d'évènement.
+    //
+    struct Slot {
+        atomic<size_t> stamp{ 0 };
+        atomic<uintptr_t> word{ 0 };
+    };
+
+    inline static Slot slots[Capacity];
+    inline static atomic<size_t> next{ 0 };
+
+    static void record(const void* node, Kind kind) noexcept {
+        size_t seq = next.fetch_add(1, memory_order_relaxed);
+        Slot& s = slots[seq & (Capacity - 1)];
+        s.stamp.store(0, memory_order_relaxed);
+        atomic_thread_fence(memory_order_release);
+        s.word.store(reinterpret_cast<uintptr_t>(node) | (kind == Kind::destroy ? 1 : 0),
+                     memory_order_relaxed);
+        s.stamp.store(seq + 1, memory_order_release);
+    }
+};